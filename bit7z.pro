@@ -5,6 +5,9 @@ CONFIG  -= app_bundle
 CONFIG  -= qt
 
 SOURCES += lib/7zSDK/C/Alloc.c \
+           lib/7zSDK/C/7zCrc.c \
+           lib/7zSDK/C/7zCrcOpt.c \
+           lib/7zSDK/C/CpuArch.c \
            lib/7zSDK/CPP/Windows/FileIO.cpp \
            lib/7zSDK/CPP/Windows/FileDir.cpp \
            lib/7zSDK/CPP/Windows/FileName.cpp \
@@ -14,18 +17,25 @@ SOURCES += lib/7zSDK/C/Alloc.c \
            lib/7zSDK/CPP/Common/IntToString.cpp \
            lib/7zSDK/CPP/Common/MyString.cpp \
            lib/7zSDK/CPP/Common/MyVector.cpp \
+           src/arenaextractcallback.cpp \
            src/bit7zlibrary.cpp \
            src/bitarchivecreator.cpp \
            src/bitarchivehandler.cpp \
            src/bitarchiveinfo.cpp \
            src/bitarchiveitem.cpp \
            src/bitarchiveopener.cpp \
+           src/bitarchivepool.cpp \
+           src/bitarenamap.cpp \
+           src/bitblockcache.cpp \
+           src/bitchunkvisitor.cpp \
            src/bitcompressor.cpp \
            src/bitexception.cpp \
+           src/bitextractionscheduler.cpp \
            src/bitextractor.cpp \
            src/bitformat.cpp \
            src/bitguids.cpp \
            src/bitinputarchive.cpp \
+           src/bititemreader.cpp \
            src/bitmemcompressor.cpp \
            src/bitmemextractor.cpp \
            src/bitpropvariant.cpp \
@@ -35,19 +45,31 @@ SOURCES += lib/7zSDK/C/Alloc.c \
            src/bufferupdatecallback.cpp \
            src/callback.cpp \
            src/cbufoutstream.cpp \
+           src/cfilemappinginstream.cpp \
            src/cmultivoloutstream.cpp \
            src/cstdinstream.cpp \
            src/cstdoutstream.cpp \
+           src/cvisitoroutstream.cpp \
+           src/cwritebehindoutstream.cpp \
+           src/deferredmetadata.cpp \
            src/extractcallback.cpp \
            src/fileextractcallback.cpp \
            src/fileupdatecallback.cpp \
            src/fsindexer.cpp \
            src/fsitem.cpp \
            src/fsutil.cpp \
+           src/indexedextractcallback.cpp \
+           src/itemscache.cpp \
+           src/itemspathindex.cpp \
            src/opencallback.cpp \
+           src/parallelfor.cpp \
            src/streamextractcallback.cpp \
            src/streamupdatecallback.cpp \
-           src/updatecallback.cpp
+           src/updatecallback.cpp \
+           src/visitorextractcallback.cpp \
+           src/wildcardpattern.cpp \
+           src/wildcardset.cpp \
+           src/writebehindqueue.cpp
 
 INCLUDEPATH += lib/7zSDK/CPP/
 
@@ -58,23 +80,31 @@ QMAKE_CXXFLAGS_WARN_ON += -W4 #-analyze
 
 DEFINES += _UNICODE _7Z_VOL
 
-HEADERS += include/bit7z.hpp \
+HEADERS += include/arenaextractcallback.hpp \
+           include/bit7z.hpp \
            include/bit7zlibrary.hpp \
            include/bitarchivecreator.hpp \
            include/bitarchivehandler.hpp \
            include/bitarchiveinfo.hpp \
            include/bitarchiveitem.hpp \
            include/bitarchiveopener.hpp \
+           include/bitarchivepool.hpp \
+           include/bitarenamap.hpp \
+           include/bitblockcache.hpp \
+           include/bitchunkvisitor.hpp \
            include/bitcompressionlevel.hpp \
            include/bitcompressionmethod.hpp \
            include/bitcompressor.hpp \
            include/bitexception.hpp \
+           include/bitextractionscheduler.hpp \
            include/bitextractor.hpp \
            include/bitformat.hpp \
            include/bitguids.hpp \
            include/bitinputarchive.hpp \
+           include/bititemreader.hpp \
            include/bitmemcompressor.hpp \
            include/bitmemextractor.hpp \
+           include/bitoverwritemode.hpp \
            include/bitpropvariant.hpp \
            include/bitstreamcompressor.hpp \
            include/bitstreamextractor.hpp \
@@ -83,19 +113,31 @@ HEADERS += include/bit7z.hpp \
            include/bufferupdatecallback.hpp \
            include/callback.hpp \
            include/cbufoutstream.hpp \
+           include/cfilemappinginstream.hpp \
            include/cmultivoloutstream.hpp \
            include/cstdinstream.hpp \
            include/cstdoutstream.hpp \
+           include/cvisitoroutstream.hpp \
+           include/cwritebehindoutstream.hpp \
+           include/deferredmetadata.hpp \
            include/extractcallback.hpp \
            include/fileextractcallback.hpp \
            include/fileupdatecallback.hpp \
            include/fsindexer.hpp \
            include/fsitem.hpp \
            include/fsutil.hpp \
+           include/indexedextractcallback.hpp \
+           include/itemscache.hpp \
+           include/itemspathindex.hpp \
            include/opencallback.hpp \
+           include/parallelfor.hpp \
            include/streamextractcallback.hpp \
            include/streamupdatecallback.hpp \
-           include/updatecallback.hpp
+           include/updatecallback.hpp \
+           include/visitorextractcallback.hpp \
+           include/wildcardpattern.hpp \
+           include/wildcardset.hpp \
+           include/writebehindqueue.hpp
 
 contains(QT_ARCH, i386) {
     QMAKE_LFLAGS         += /MACHINE:X86
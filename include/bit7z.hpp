@@ -26,6 +26,7 @@
 #include "bitextractor.hpp"
 #include "bitmemextractor.hpp"
 #include "bitstreamextractor.hpp"
+#include "bitextractionscheduler.hpp"
 #include "bitexception.hpp"
 
 #endif // BIT7Z_HPP
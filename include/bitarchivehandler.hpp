@@ -81,6 +81,22 @@ namespace bit7z {
              */
             bool isPasswordDefined() const;
 
+            /**
+             * @return true if the archives opened by the handler cache the main properties of their items.
+             */
+            bool itemsCaching() const;
+
+            /**
+             * @return true if the archive files opened by the handler are read through a memory mapping.
+             */
+            bool memoryMapping() const;
+
+            /**
+             * @return true if the item tables of the archive files opened by the handler are persisted in (and read
+             * from) sidecar index files.
+             */
+            bool sidecarIndex() const;
+
             /**
              * @return the current total callback.
              */
@@ -136,6 +152,58 @@ namespace bit7z {
              */
             void clearPassword();
 
+            /**
+             * @brief Sets whether the archives opened by the handler must cache the main properties of their items.
+             *
+             * When enabled, the path, folder/encryption flags, sizes, modification time, attributes, CRC and solid
+             * block of all the items are read once, when the archive is opened, and all the subsequent accesses to them do not
+             * query the archive anymore. This speeds up the handling of archives with a large number of items, at
+             * the cost of a slower opening and some additional memory.
+             *
+             * @note By default, items properties are not cached.
+             *
+             * @param enable  if true, items properties will be cached.
+             */
+            void setItemsCaching( bool enable );
+
+            /**
+             * @brief Sets whether the archive files opened by the handler must be read through a read-only memory
+             * mapping of their content, rather than through normal file reads.
+             *
+             * @note If an archive file cannot be mapped (e.g. it is empty, or it does not fit in the address space of
+             * the process), it is read normally.
+             *
+             * @note By default, memory mapping is not used.
+             *
+             * @param enable  if true, archive files will be memory mapped.
+             */
+            void setMemoryMapping( bool enable );
+
+            /**
+             * @brief Sets whether the item tables of the archive files opened by the handler must be persisted in
+             * sidecar index files.
+             *
+             * When enabled, the first time an archive file is opened its items properties are cached (as with
+             * setItemsCaching) and saved in a sidecar file having the same path of the archive plus the ".bit7zidx"
+             * extension. Subsequent openings of the same archive read the item table from the sidecar file, without
+             * parsing the archive headers: the archive itself is opened only when needed (e.g. when extracting it,
+             * or when reading an archive property or an item property not stored in the index).
+             *
+             * @note A sidecar file is used only if it matches the size, the last modification time and a hash of the
+             * head and tail of the archive file; otherwise, it is rebuilt.
+             *
+             * @note Failing to write a sidecar file (e.g. the archive is in a read-only folder) is not an error.
+             *
+             * @note Since sidecar files store the items table unencrypted, they are neither written nor read when the
+             * handler has a password defined, and they are not written for archives whose headers are encrypted
+             * (i.e. archives requiring a password to be opened, for example via the password callback).
+             *
+             * @note By default, sidecar index files are not used.
+             *
+             * @param enable  if true, sidecar index files will be used.
+             */
+            void setSidecarIndex( bool enable );
+
             /**
              * @brief Sets the callback to be called when the total size of an operation is available.
              *
@@ -181,6 +249,9 @@ namespace bit7z {
         protected:
             const Bit7zLibrary& mLibrary;
             wstring mPassword;
+            bool mItemsCaching;
+            bool mMemoryMapping;
+            bool mSidecarIndex;
 
             explicit BitArchiveHandler( const Bit7zLibrary& lib );
 
@@ -29,6 +29,22 @@ struct IOutArchive;
 struct IArchiveExtractCallback;
 
 namespace bit7z {
+    /**
+     * @brief The BitArchiveStatistics struct contains aggregated information on the items of an archive.
+     */
+    struct BitArchiveStatistics {
+        uint32_t foldersCount;          ///< The number of folders in the archive.
+        uint32_t filesCount;            ///< The number of files in the archive.
+        uint32_t encryptedFilesCount;   ///< The number of encrypted files in the archive.
+        uint64_t size;                  ///< The total uncompressed size of the archive content.
+        uint64_t packSize;              ///< The total compressed size of the archive content.
+        uint32_t largestItemIndex;      ///< The index of the largest item (meaningful only if largestItemSize > 0).
+        uint64_t largestItemSize;       ///< The uncompressed size of the largest item.
+        bool hasModifiedTimes;          ///< true if and only if at least one item has a last modified time.
+        FILETIME minModifiedTime;       ///< The oldest last modified time of the items (if hasModifiedTimes).
+        FILETIME maxModifiedTime;       ///< The newest last modified time of the items (if hasModifiedTimes).
+    };
+
     /**
      * @brief The BitArchiveInfo class allows to retrieve metadata information of archives and their content.
      */
@@ -66,6 +82,26 @@ namespace bit7z {
                             const vector< byte_t >& in_buffer,
                             const BitInFormat& format DEFAULT_FORMAT );
 
+            /**
+             * @brief Constructs a BitArchiveInfo object, opening the archive in the given memory region.
+             *
+             * @note The memory region is not copied: it must remain valid for the whole lifetime of the object.
+             *
+             * @note When bit7z is compiled using the BIT7Z_AUTO_FORMAT macro define, the format
+             * argument has default value BitFormat::Auto (automatic format detection of the input archive).
+             * On the other hand, when BIT7Z_AUTO_FORMAT is not defined (i.e. no auto format detection available)
+             * the format argument must be specified.
+             *
+             * @param lib               the 7z library used.
+             * @param in_buffer         the pointer to the memory region containing the archive.
+             * @param in_buffer_size    the size of the memory region.
+             * @param format            the input archive format.
+             */
+            BitArchiveInfo( const Bit7zLibrary& lib,
+                            const byte_t* in_buffer,
+                            size_t in_buffer_size,
+                            const BitInFormat& format DEFAULT_FORMAT );
+
             /**
              * @brief Constructs a BitArchiveInfo object, opening the archive from the standard input stream.
              *
@@ -99,6 +135,29 @@ namespace bit7z {
              */
             vector< BitArchiveItem > items() const;
 
+            /**
+             * @brief Retrieves only the specified properties of all the archive items.
+             *
+             * @note Differently from items(), this method queries the archive only for the given properties, hence
+             * its cost is proportional to the number of requested properties rather than to all the possible ones.
+             *
+             * @param properties    the properties to be retrieved for each item.
+             *
+             * @return a vector of all the archive items as BitArchiveItem objects, each one having only the
+             * available (i.e. non empty) values of the requested properties.
+             */
+            vector< BitArchiveItem > items( const vector< BitProperty >& properties ) const;
+
+            /**
+             * @brief Computes, in a single pass over the archive items, the aggregated information on them.
+             *
+             * @note The result is computed only the first time, and then it is reused by any subsequent call to this
+             * method, as well as by foldersCount(), filesCount(), size(), packSize() and hasEncryptedItems().
+             *
+             * @return the statistics of the archive items.
+             */
+            const BitArchiveStatistics& statistics() const;
+
             /**
              * @return the number of folders contained in the archive.
              */
@@ -138,6 +197,10 @@ namespace bit7z {
              * @return true if and only if the archive was created using solid compression.
              */
             bool isSolid() const;
+
+        private:
+            mutable bool mHasStatistics;
+            mutable BitArchiveStatistics mStatistics;
     };
 }
 
@@ -21,17 +21,24 @@
 
 #include <vector>
 #include <map>
+#include <functional>
 
 #include "../include/bitarchivehandler.hpp"
 #include "../include/bitformat.hpp"
+#include "../include/bitoverwritemode.hpp"
 #include "../include/bittypes.hpp"
 
 namespace bit7z {
     using std::vector;
     using std::map;
     using std::ostream;
+    using std::function;
 
     class BitInputArchive;
+    class BitArenaMap;
+    class BitChunkVisitor;
+    class WriteBehindQueue;
+    class DeferredMetadata;
 
     /**
      * @brief Abstract class representing a generic archive opener.
@@ -49,8 +56,119 @@ namespace bit7z {
              */
             const BitInFormat& extractionFormat() const;
 
+            /**
+             * @return the behaviour of the extraction when an output file already exists.
+             */
+            BitOverwriteMode overwriteMode() const;
+
+            /**
+             * @return true if the CRCs of the existing files are compared with the ones of the archive items
+             * when using the BitOverwriteMode::SKIP_IF_IDENTICAL mode.
+             */
+            bool crcComparison() const;
+
+            /**
+             * @return the number of writer threads used when extracting to the file system (0 if the files are
+             * written by the decoding thread).
+             */
+            uint32_t writeBehindThreads() const;
+
+            /**
+             * @return the maximum size of the extracted data waiting to be written by the writer threads.
+             */
+            size_t writeBehindMemory() const;
+
+            /**
+             * @return the minimum size of the extracted files whose space is preallocated (0 if preallocation is
+             * disabled).
+             */
+            uint64_t preallocationThreshold() const;
+
+            /**
+             * @return true if the metadata of the extracted items is applied at the end of the extraction.
+             */
+            bool deferredMetadata() const;
+
+            /**
+             * @brief Sets how the extraction must behave when an output file already exists on the file system.
+             *
+             * @note By default, existing files are overwritten.
+             *
+             * @param mode  the overwrite mode to be used.
+             */
+            void setOverwriteMode( BitOverwriteMode mode );
+
+            /**
+             * @brief Sets whether, when using the BitOverwriteMode::SKIP_IF_IDENTICAL mode, an existing file having
+             * the same size and modification time of the archive item must also have its same CRC to be kept.
+             *
+             * @note When enabled, the existing files are read entirely, and the items having no CRC in the archive
+             * are always extracted.
+             *
+             * @note By default, CRCs are not compared.
+             *
+             * @param enable  if true, the CRCs of the existing files will be compared with the ones of the items.
+             */
+            void setCrcComparison( bool enable );
+
+            /**
+             * @brief Sets the number of threads writing the extracted files to the file system.
+             *
+             * When enabled, the decoded data is handed (in chunks) to a pool of writer threads, so that decoding
+             * does not wait for the writes and the closing of the output files. If the data waiting to be written
+             * exceeds the given memory budget, decoding is suspended until some data is written.
+             *
+             * @note The writer threads and the memory budget are shared by all the decoding threads of a parallel
+             * extraction (see BitExtractor::setThreadsCount).
+             *
+             * @note By default, the extracted files are written by the decoding thread.
+             *
+             * @param writer_threads    the number of writer threads (0 to disable the write-behind).
+             * @param memory_budget     the maximum size of the decoded data waiting to be written.
+             */
+            void setWriteBehind( uint32_t writer_threads, size_t memory_budget = 64 * 1024 * 1024 );
+
+            /**
+             * @brief Sets the minimum size of the extracted files whose space must be preallocated on the file system.
+             *
+             * When extracting a file whose size (as reported by the archive) is at least the given threshold, the
+             * output file is extended to that size as soon as it is created, so that the file system can allocate
+             * its space at once (reducing the fragmentation of large files extracted concurrently). Once the file is
+             * extracted (or if its extraction is aborted), it is truncated to the size of the actually written data.
+             *
+             * @note Since the size of a file is declared by the archive, the file is not preallocated if its size does
+             *       not fit in the free disk space, or if it is implausibly large with respect to its packed size.
+             *
+             * @note By default, preallocation is disabled.
+             *
+             * @param threshold  the minimum size of the files to be preallocated (0 to disable preallocation).
+             */
+            void setPreallocationThreshold( uint64_t threshold );
+
+            /**
+             * @brief Sets whether the attributes and the modification times of the extracted items must be applied
+             * all together at the end of the extraction to the file system, rather than after each item.
+             *
+             * When enabled, the attributes of the extracted files are applied in parallel batches once the extraction
+             * is completed (the modification times of the files are still set on their open handles). Then, the
+             * attributes and the modification times of the extracted folders are applied, from the innermost to the
+             * outermost, so that they are not changed by the creation of the items they contain.
+             *
+             * @note By default, the metadata of each item is applied as soon as the item is extracted, and the
+             * modification times of the folders are not restored.
+             *
+             * @param enable  if true, the metadata of the extracted items will be applied at the end of the extraction.
+             */
+            void setDeferredMetadata( bool enable );
+
         protected:
             const BitInFormat& mFormat;
+            BitOverwriteMode mOverwriteMode;
+            bool mCrcComparison;
+            uint32_t mWriteBehindThreads;
+            size_t mWriteBehindMemory;
+            uint64_t mPreallocationThreshold;
+            bool mDeferredMetadata;
 
             BitArchiveOpener( const Bit7zLibrary& lib, const BitInFormat& format );
 
@@ -61,6 +179,19 @@ namespace bit7z {
                                       const wstring& out_dir,
                                       const vector< uint32_t >& indices ) const;
 
+            void extractToFileSystem( const BitInputArchive& in_archive,
+                                      const wstring& in_file,
+                                      const wstring& out_dir,
+                                      const vector< uint32_t >& indices,
+                                      WriteBehindQueue* write_queue,
+                                      DeferredMetadata* deferred_metadata ) const;
+
+            /* Runs the given extraction(s) to the file system, providing them the write-behind queue and the deferred
+             * metadata (if enabled) to be shared by all of them; once the extraction is completed (or failed), waits
+             * for the queue to write all the files, and applies the deferred metadata */
+            void runFileSystemExtraction(
+                const function< void( WriteBehindQueue*, DeferredMetadata* ) >& extraction ) const;
+
             void extractToBuffer( const BitInputArchive& in_archive,
                                   vector< byte_t >& out_buffer,
                                   unsigned int index ) const;
@@ -71,6 +202,16 @@ namespace bit7z {
 
             void extractToBufferMap( const BitInputArchive& in_archive,
                                      map< wstring, vector< byte_t > >& out_map ) const;
+
+            void extractToArenaMap( const BitInputArchive& in_archive, BitArenaMap& out_arena ) const;
+
+            void extractToBuffers( const BitInputArchive& in_archive,
+                                   const vector< uint32_t >& indices,
+                                   vector< vector< byte_t > >& out_buffers ) const;
+
+            void extractToVisitor( const BitInputArchive& in_archive,
+                                   const vector< uint32_t >& indices,
+                                   BitChunkVisitor& visitor ) const;
     };
 }
 
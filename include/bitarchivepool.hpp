@@ -0,0 +1,121 @@
+/*
+ * bit7z - A C++ static library to interface with the 7-zip DLLs.
+ * Copyright (c) 2014-2019  Riccardo Ostani - All Rights Reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * Bit7z is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with bit7z; if not, see https://www.gnu.org/licenses/.
+ */
+
+#ifndef BITARCHIVEPOOL_HPP
+#define BITARCHIVEPOOL_HPP
+
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <cstdint>
+
+#include "../include/bitarchivehandler.hpp"
+#include "../include/bitinputarchive.hpp"
+
+namespace bit7z {
+    using std::list;
+    using std::shared_ptr;
+    using std::unique_ptr;
+    using std::wstring;
+
+    /**
+     * @brief The BitArchivePool class keeps the recently used archive files open, so that subsequent operations on
+     * them do not need to open them again (i.e. to detect their format and to parse their headers).
+     *
+     * Archives are checked out exclusively: an archive leased from the pool is not available to other operations
+     * until the lease is released (i.e. until the last copy of the returned pointer is destroyed), and then it is
+     * returned to the pool, where at most maxIdleArchives() archives are kept open (the least recently used ones are
+     * closed first).
+     *
+     * Archives are identified by their path (as specified by the user), size, last modification time and format, so
+     * that an archive file modified on disk is opened again.
+     *
+     * @note Archives opened by handlers having a password defined, as well as archives whose headers are encrypted,
+     * are never kept in the pool (i.e. they are closed as soon as their lease is released), so that they cannot be
+     * leased to handlers not knowing their password.
+     *
+     * @note A pool can be shared among several extractors and threads.
+     *
+     * @note Only the operations of BitExtractor lease archives from the pool. A BitArchiveInfo object is itself the
+     * archive it opens (and it keeps it open for its whole lifetime), so listing an archive through a new
+     * BitArchiveInfo object always opens it again: to list an archive repeatedly, reuse the same BitArchiveInfo object.
+     */
+    class BitArchivePool {
+        public:
+            /**
+             * @brief Constructs an empty BitArchivePool object.
+             *
+             * @param max_idle_archives the maximum number of archives kept open while not being used.
+             */
+            explicit BitArchivePool( size_t max_idle_archives );
+
+            /**
+             * @brief BitArchivePool destructor.
+             *
+             * @note Archives still leased are closed when their lease is released.
+             */
+            virtual ~BitArchivePool();
+
+            /**
+             * @return the maximum number of archives kept open while not being used.
+             */
+            size_t maxIdleArchives() const;
+
+            /**
+             * @return the number of archives currently kept open while not being used.
+             */
+            size_t idleArchivesCount() const;
+
+            /**
+             * @brief Leases the given archive file, opening it only if no idle handle to it is in the pool.
+             *
+             * @param handler   the archive handler whose settings (format, password, callbacks) are used.
+             * @param in_file   the archive file to be leased.
+             *
+             * @return the leased archive.
+             */
+            shared_ptr< BitInputArchive > acquire( const BitArchiveHandler& handler, const wstring& in_file );
+
+            /**
+             * @brief Closes all the archives currently kept open while not being used.
+             */
+            void clear();
+
+        private:
+            struct IdleArchive {
+                wstring path;
+                uint64_t size;
+                uint64_t lastWriteTime;
+                const BitInFormat* format;
+                shared_ptr< BitInputArchive > archive;
+            };
+
+            struct State {
+                size_t maxIdleArchives;
+                std::mutex mutex;
+                list< IdleArchive > idleArchives; // from the most to the least recently used
+            };
+
+            shared_ptr< State > mState;
+
+            static void release( const std::weak_ptr< State >& weak_state, IdleArchive& idle_archive );
+    };
+}
+
+#endif // BITARCHIVEPOOL_HPP
@@ -0,0 +1,130 @@
+/*
+ * bit7z - A C++ static library to interface with the 7-zip DLLs.
+ * Copyright (c) 2014-2019  Riccardo Ostani - All Rights Reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * Bit7z is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with bit7z; if not, see https://www.gnu.org/licenses/.
+ */
+
+#ifndef BITARENAMAP_HPP
+#define BITARENAMAP_HPP
+
+#include <vector>
+#include <string>
+#include <cstdint>
+
+#include "../include/bittypes.hpp"
+
+namespace bit7z {
+    using std::vector;
+    using std::wstring;
+
+    /**
+     * @brief The BitArenaMap class holds the result of the bulk extraction of an archive to memory.
+     *
+     * Differently from a map of buffers, the contents of all the extracted files are stored contiguously in a single
+     * memory arena (sized from the total unpacked size of the files), and their paths in a single pool of characters,
+     * so that the number of memory allocations does not depend on the number of extracted files.
+     *
+     * Files are identified by their position (from 0 to size() - 1) in the extraction order; a file can also be
+     * looked up by its path, using the find method.
+     */
+    class BitArenaMap {
+        public:
+            /**
+             * @brief Constructs an empty BitArenaMap object.
+             */
+            BitArenaMap();
+
+            /**
+             * @return the number of files in the map.
+             */
+            size_t size() const;
+
+            /**
+             * @return true if and only if the map contains no files.
+             */
+            bool empty() const;
+
+            /**
+             * @param pos   the position of a file in the map.
+             *
+             * @return the path (inside the archive) of the file at the given position.
+             */
+            wstring path( size_t pos ) const;
+
+            /**
+             * @param pos   the position of a file in the map.
+             *
+             * @return the index (in the archive) of the file at the given position.
+             */
+            uint32_t index( size_t pos ) const;
+
+            /**
+             * @param pos   the position of a file in the map.
+             *
+             * @return a pointer to the content of the file at the given position.
+             */
+            const byte_t* data( size_t pos ) const;
+
+            /**
+             * @param pos   the position of a file in the map.
+             *
+             * @return the size of the content of the file at the given position.
+             */
+            size_t dataSize( size_t pos ) const;
+
+            /**
+             * @brief Searches the file having the given path.
+             *
+             * @param path  the path (inside the archive) of the file to be searched.
+             * @param pos   the variable where the position of the file is stored, if found.
+             *
+             * @return true if and only if a file with the given path is in the map.
+             */
+            bool find( const wstring& path, size_t& pos ) const;
+
+            /**
+             * @return the memory arena containing the contents of all the files.
+             */
+            const vector< byte_t >& arena() const;
+
+            /**
+             * @brief Removes all the files from the map.
+             */
+            void clear();
+
+        private:
+            struct Entry {
+                size_t pathOffset;
+                size_t pathLength;
+                size_t dataOffset;
+                size_t dataSize;
+                uint32_t index;
+            };
+
+            vector< byte_t > mArena;
+            vector< wchar_t > mPaths;
+            vector< Entry > mEntries;
+            vector< size_t > mSortedEntries; // positions of the entries, sorted by path
+
+            int comparePath( size_t pos, const wchar_t* path, size_t path_length ) const;
+
+            void buildIndex();
+
+            friend class ArenaExtractCallback;
+            friend class BitArchiveOpener;
+    };
+}
+
+#endif // BITARENAMAP_HPP
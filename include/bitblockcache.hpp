@@ -0,0 +1,137 @@
+/*
+ * bit7z - A C++ static library to interface with the 7-zip DLLs.
+ * Copyright (c) 2014-2019  Riccardo Ostani - All Rights Reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * Bit7z is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with bit7z; if not, see https://www.gnu.org/licenses/.
+ */
+
+#ifndef BITBLOCKCACHE_HPP
+#define BITBLOCKCACHE_HPP
+
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include "../include/bittypes.hpp"
+
+namespace bit7z {
+    using std::list;
+    using std::map;
+    using std::shared_ptr;
+    using std::vector;
+    using std::wstring;
+
+    /**
+     * @brief The BitBlockCache class is a memory-bounded LRU cache of the decoded solid blocks of archives.
+     *
+     * When a cache is set on a BitExtractor, the extraction of a single item of a solid archive to a buffer decodes
+     * the whole solid block containing the item, and it stores the decoded content of all the block files in the
+     * cache: subsequent extractions of any of these files are then served by a copy from the cache, without opening
+     * the archive. The least recently used blocks are evicted when the total size of the cached blocks exceeds the
+     * budget of the cache.
+     *
+     * Archives are identified by their path (as specified by the user), size and last modification time, so that
+     * a modified archive does not match the blocks cached for its previous content.
+     *
+     * @note A cache can be shared among several extractors and threads.
+     */
+    class BitBlockCache {
+        public:
+            /**
+             * @brief Constructs an empty BitBlockCache object.
+             *
+             * @param budget    the maximum total size (in bytes) of the decoded blocks kept in the cache.
+             */
+            explicit BitBlockCache( uint64_t budget );
+
+            /**
+             * @return the maximum total size (in bytes) of the decoded blocks kept in the cache.
+             */
+            uint64_t budget() const;
+
+            /**
+             * @return the total size (in bytes) of the decoded blocks currently kept in the cache.
+             */
+            uint64_t usedSize() const;
+
+            /**
+             * @return the number of blocks currently kept in the cache.
+             */
+            size_t blocksCount() const;
+
+            /**
+             * @return the number of item lookups served by the cache.
+             */
+            uint64_t hits() const;
+
+            /**
+             * @return the number of item lookups not served by the cache.
+             */
+            uint64_t misses() const;
+
+            /**
+             * @brief Removes all the blocks from the cache (the hits and misses counters are not reset).
+             */
+            void clear();
+
+        private:
+            struct ArchiveId {
+                wstring path;
+                uint64_t size;
+                uint64_t lastWriteTime;
+
+                bool operator<( const ArchiveId& other ) const;
+            };
+
+            struct Block {
+                ArchiveId archive;
+                uint64_t id;
+                uint64_t size; // total size of the buffers
+                vector< uint32_t > indices; // indices of the block items, in ascending order
+                vector< vector< byte_t > > buffers; // decoded content of the items, aligned with indices
+            };
+
+            typedef list< shared_ptr< Block > >::iterator BlockIterator;
+
+            // Cached blocks of an archive
+            struct CachedArchive {
+                map< uint64_t, BlockIterator > blocks; // by block id
+                map< uint32_t, uint64_t > itemsBlocks; // id of the block containing each cached item
+            };
+
+            uint64_t mBudget;
+            uint64_t mUsedSize;
+            uint64_t mHits;
+            uint64_t mMisses;
+            list< shared_ptr< Block > > mBlocks; // from the most to the least recently used
+            map< ArchiveId, CachedArchive > mArchives;
+            mutable std::mutex mMutex;
+
+            bool get( const ArchiveId& archive, uint32_t index, vector< byte_t >& out_buffer );
+
+            void put( const shared_ptr< Block >& block );
+
+            void evictLeastRecentlyUsed();
+
+            static const vector< byte_t >* findItem( const Block& block, uint32_t index );
+
+            friend class BitExtractor;
+    };
+}
+
+#endif // BITBLOCKCACHE_HPP
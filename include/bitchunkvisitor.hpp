@@ -0,0 +1,83 @@
+/*
+ * bit7z - A C++ static library to interface with the 7-zip DLLs.
+ * Copyright (c) 2014-2019  Riccardo Ostani - All Rights Reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * Bit7z is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with bit7z; if not, see https://www.gnu.org/licenses/.
+ */
+
+#ifndef BITCHUNKVISITOR_HPP
+#define BITCHUNKVISITOR_HPP
+
+#include <string>
+#include <cstdint>
+
+#include "../include/bittypes.hpp"
+
+namespace bit7z {
+    using std::wstring;
+
+    /**
+     * @brief The BitChunkVisitor class is the base class for objects receiving the content of the extracted items
+     * chunk by chunk, as soon as it is decoded (i.e. without buffering it).
+     *
+     * For each extracted file, onItemBegin is called first, then onChunk is called for each decoded chunk of its
+     * content and, finally, onItemEnd is called. Folders are not visited.
+     *
+     * Any of the methods can return false to abort the extraction: in such case, a BitException with error code
+     * E_ABORT is thrown by the extraction method. Likewise, an exception thrown by any of the methods aborts the
+     * extraction, and it is rethrown by the extraction method.
+     */
+    class BitChunkVisitor {
+        public:
+            /**
+             * @brief BitChunkVisitor destructor.
+             */
+            virtual ~BitChunkVisitor();
+
+            /**
+             * @brief Called when the extraction of an item begins.
+             *
+             * @param index the index (in the archive) of the item.
+             * @param path  the path (inside the archive) of the item.
+             *
+             * @return true to continue the extraction, false to abort it.
+             */
+            virtual bool onItemBegin( uint32_t index, const wstring& path );
+
+            /**
+             * @brief Called for each decoded chunk of the content of the current item.
+             *
+             * @note The data is valid only for the duration of the call.
+             *
+             * @param index the index (in the archive) of the item.
+             * @param data  the pointer to the decoded data.
+             * @param size  the size of the decoded data.
+             *
+             * @return true to continue the extraction, false to abort it.
+             */
+            virtual bool onChunk( uint32_t index, const byte_t* data, size_t size ) = 0;
+
+            /**
+             * @brief Called when the extraction of an item ends.
+             *
+             * @param index     the index (in the archive) of the item.
+             * @param succeeded true if the item was decoded successfully (e.g. no CRC or data errors).
+             *
+             * @return true to continue the extraction, false to abort it.
+             */
+            virtual bool onItemEnd( uint32_t index, bool succeeded );
+    };
+}
+
+#endif // BITCHUNKVISITOR_HPP
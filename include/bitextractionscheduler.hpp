@@ -0,0 +1,110 @@
+/*
+ * bit7z - A C++ static library to interface with the 7-zip DLLs.
+ * Copyright (c) 2014-2019  Riccardo Ostani - All Rights Reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * Bit7z is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with bit7z; if not, see https://www.gnu.org/licenses/.
+ */
+
+#ifndef BITEXTRACTIONSCHEDULER_HPP
+#define BITEXTRACTIONSCHEDULER_HPP
+
+#include <list>
+#include <vector>
+#include <string>
+#include <future>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cstdint>
+
+#include "../include/bitextractor.hpp"
+#include "../include/bitinputarchive.hpp"
+#include "../include/bittypes.hpp"
+
+namespace bit7z {
+    using std::list;
+    using std::vector;
+    using std::wstring;
+
+    /**
+     * @brief The BitExtractionScheduler class allows to extract single items of an archive to memory asynchronously,
+     * decoding each solid block of the archive only once for all the items requested in the meantime.
+     *
+     * Requests are collected while the scheduler is busy; then, all the pending requests are grouped by the solid
+     * block containing the requested items (as reported by the archive format), and each group is satisfied with a
+     * single sequential decoding of its block. Hence, a burst of requests of single items costs one decoding pass per
+     * block, rather than one per item.
+     *
+     * @note The archive is kept open for the whole lifetime of the scheduler, and it is accessed only by its worker
+     * thread (which also calls the callbacks of the extractor, if any). The extractor must outlive the scheduler.
+     */
+    class BitExtractionScheduler {
+        public:
+            /**
+             * @brief Constructs a BitExtractionScheduler object, opening the given archive file.
+             *
+             * @param extractor the extractor whose settings (format, password, callbacks) are used.
+             * @param in_file   the input archive file.
+             */
+            BitExtractionScheduler( const BitExtractor& extractor, const wstring& in_file );
+
+            /**
+             * @brief BitExtractionScheduler destructor.
+             *
+             * @note It waits for all the pending requests to be satisfied.
+             */
+            virtual ~BitExtractionScheduler();
+
+            /**
+             * @return the number of items in the archive.
+             */
+            uint32_t itemsCount() const;
+
+            /**
+             * @brief Requests the extraction to memory of the specified item.
+             *
+             * @note Folders are extracted as empty buffers.
+             *
+             * @param index the index of the item in the archive.
+             *
+             * @return the future content of the item; if the extraction fails, the future holds the corresponding
+             * BitException.
+             */
+            std::future< vector< byte_t > > request( uint32_t index );
+
+        private:
+            struct Request {
+                explicit Request( uint32_t item_index ) : index( item_index ) {}
+
+                uint32_t index;
+                std::promise< vector< byte_t > > result;
+            };
+
+            const BitExtractor& mExtractor;
+            BitInputArchive mInArchive;
+            uint32_t mItemsCount;
+
+            list< Request > mPendingRequests;
+            bool mStopping;
+            std::mutex mMutex;
+            std::condition_variable mRequestsAvailable;
+            std::thread mWorker;
+
+            void run();
+
+            void process( list< Request >& requests );
+    };
+}
+
+#endif // BITEXTRACTIONSCHEDULER_HPP
@@ -20,6 +20,10 @@
 #define BITEXTRACTOR_HPP
 
 #include "../include/bitarchiveopener.hpp"
+#include "../include/bitarchivepool.hpp"
+#include "../include/bitarenamap.hpp"
+#include "../include/bitblockcache.hpp"
+#include "../include/bitchunkvisitor.hpp"
 #include "../include/bittypes.hpp"
 
 struct IInArchive;
@@ -27,6 +31,23 @@ struct IInArchive;
 namespace bit7z {
     class BitInputArchive;
 
+    /**
+     * @brief A job of a batch extraction, i.e. an archive file to be extracted into an output directory.
+     */
+    struct BitBatchJob {
+        wstring inFile; ///< the input archive file.
+        wstring outDir; ///< the output directory where extracted files will be put.
+    };
+
+    /**
+     * @brief The outcome of a job of a batch extraction.
+     */
+    struct BitBatchResult {
+        wstring inFile;            ///< the input archive file of the job.
+        HRESULT errorCode;         ///< S_OK if the job succeeded, otherwise the error code of the job's exception.
+        std::string errorMessage;  ///< the message of the job's exception, or an empty string if the job succeeded.
+    };
+
     /**
      * @brief The BitExtractor class allows to extract the content of file archives.
      */
@@ -49,6 +70,56 @@ namespace bit7z {
              */
             explicit BitExtractor( const Bit7zLibrary& lib, const BitInFormat& format DEFAULT_FORMAT );
 
+            /**
+             * @return the maximum number of threads used by the extractor.
+             */
+            uint32_t threadsCount() const;
+
+            /**
+             * @brief Sets the maximum number of threads that can be used by the extractor.
+             *
+             * @note By default, the extractor uses a single thread (i.e. the calling one).
+             *
+             * @note When using more than one thread, the extraction of a non-solid archive file to the filesystem
+             * is split among several workers, each one decoding a part of the archive items using its own handle
+             * to the archive file. Solid archives are always extracted by a single thread.
+             *
+             * @param threads_count the maximum number of threads (0 means one thread for each hardware core).
+             */
+            void setThreadsCount( uint32_t threads_count );
+
+            /**
+             * @return the cache of decoded solid blocks used by the extractor (nullptr if none).
+             */
+            shared_ptr< BitBlockCache > blockCache() const;
+
+            /**
+             * @brief Sets the cache of decoded solid blocks to be used when extracting single items to buffers.
+             *
+             * @note The cache is not used when a password is defined, and the blocks of encrypted archives are never
+             *       cached, so that a shared cache cannot serve decrypted data to extractors without the password.
+             *
+             * @note By default, no cache is used.
+             *
+             * @param cache the cache to be used (nullptr to disable caching).
+             */
+            void setBlockCache( const shared_ptr< BitBlockCache >& cache );
+
+            /**
+             * @return the pool of open archives used by the extractor (nullptr if none).
+             */
+            shared_ptr< BitArchivePool > archivePool() const;
+
+            /**
+             * @brief Sets the pool of open archives to be used by the extractor, so that the archive files
+             * are not opened (and their headers are not parsed) again on each operation.
+             *
+             * @note By default, no pool is used, and each operation opens the archive file.
+             *
+             * @param pool  the pool to be used (nullptr to disable pooling).
+             */
+            void setArchivePool( const shared_ptr< BitArchivePool >& pool );
+
             /**
              * @brief Extracts the given archive into the choosen directory.
              *
@@ -68,6 +139,27 @@ namespace bit7z {
                                   const wstring& item_filter,
                                   const wstring& out_dir = L"" ) const;
 
+            /**
+             * @brief Extracts the files in the given archive matching any of the include wildcard patterns, and none
+             * of the exclude ones, into the choosen directory.
+             *
+             * @note The patterns are compiled once in a single matcher, where the patterns consisting of a literal
+             * path, prefix (e.g. "dir\\*") or suffix (e.g. "*.txt") are looked up in hash sets: hence, the matching
+             * cost does not grow with the number of such patterns.
+             *
+             * @param in_file           the input archive file.
+             * @param include_filters   the wildcard patterns of the files to be extracted (if empty, all the files
+             *                          not excluded are extracted).
+             * @param exclude_filters   the wildcard patterns of the files not to be extracted.
+             * @param out_dir           the output directory where extracted files will be put.
+             * @param case_sensitive    if false, the patterns are matched ignoring the case of the characters.
+             */
+            void extractMatching( const wstring& in_file,
+                                  const vector< wstring >& include_filters,
+                                  const vector< wstring >& exclude_filters,
+                                  const wstring& out_dir,
+                                  bool case_sensitive = true ) const;
+
 #ifdef BIT7Z_REGEX_MATCHING
             /**
              * @brief Extracts the regex matching files in the given archive into the choosen directory.
@@ -92,6 +184,22 @@ namespace bit7z {
                                const vector< uint32_t >& indices,
                                const wstring& out_dir = L"" ) const;
 
+            /**
+             * @brief Extracts the items having the specified paths in the given archive into the choosen directory.
+             *
+             * @note The items are searched using BitInputArchive::findItem, so the lookup of each path takes
+             * constant time, regardless of the number of items in the archive.
+             *
+             * @param in_file           the input archive file.
+             * @param item_paths        the paths (in the archive) of the items that must be extracted.
+             * @param out_dir           the output directory where extracted files will be put.
+             * @param case_sensitive    if false, the paths are searched ignoring the case of their characters.
+             */
+            void extractPaths( const wstring& in_file,
+                               const vector< wstring >& item_paths,
+                               const wstring& out_dir = L"",
+                               bool case_sensitive = true ) const;
+
             /**
              * @brief Extracts a file from the given archive into the output buffer.
              *
@@ -120,6 +228,72 @@ namespace bit7z {
              */
             void extract( const wstring& in_file, map< wstring, vector< byte_t > >& out_map ) const;
 
+            /**
+             * @brief Extracts the specified items in the given archive into a vector of memory buffers, aligned to
+             * the given indices (i.e. the content of the item at indices[ i ] is put in out_buffers[ i ]).
+             *
+             * @note Folders are extracted as empty buffers.
+             *
+             * @param in_file       the input archive file.
+             * @param indices       the array of indices of the items in the archive that must be extracted.
+             * @param out_buffers   the output vector of buffers.
+             */
+            void extractItems( const wstring& in_file,
+                               const vector< uint32_t >& indices,
+                               vector< vector< byte_t > >& out_buffers ) const;
+
+            /**
+             * @brief Extracts the content of the given archive, passing each decoded chunk of the files to the
+             * given visitor, without buffering it.
+             *
+             * @param in_file   the input archive file.
+             * @param visitor   the visitor receiving the content of the files.
+             */
+            void extract( const wstring& in_file, BitChunkVisitor& visitor ) const;
+
+            /**
+             * @brief Extracts the specified items in the given archive, passing each decoded chunk of the files to
+             * the given visitor, without buffering it.
+             *
+             * @note The items are visited in ascending index order, whatever the order of the given indices (which
+             * must not be repeated).
+             *
+             * @param in_file   the input archive file.
+             * @param indices   the array of indices of the items in the archive that must be extracted.
+             * @param visitor   the visitor receiving the content of the files.
+             */
+            void extractItems( const wstring& in_file,
+                               const vector< uint32_t >& indices,
+                               BitChunkVisitor& visitor ) const;
+
+            /**
+             * @brief Extracts the content of the given archive into a single memory arena, where the contents of
+             * all the files are stored contiguously and indexed by their paths (inside the archive).
+             *
+             * @note The arena is sized from the total unpacked size of the files, so that the number of memory
+             * allocations does not depend on the number of extracted files.
+             *
+             * @param in_file     the input archive file.
+             * @param out_arena   the output arena map.
+             */
+            void extract( const wstring& in_file, BitArenaMap& out_arena ) const;
+
+            /**
+             * @brief Extracts the given archives, each one into its own output directory.
+             *
+             * The jobs are executed by a pool of at most threadsCount() worker threads, each job opening its own
+             * input archive. A failing job does not stop the others: the outcome of each job is reported in the
+             * returned vector, in the same order of the input jobs.
+             *
+             * @note The callbacks of the extractor (e.g. the progress callback) can be called concurrently by
+             * different worker threads, hence they must be thread-safe.
+             *
+             * @param jobs  the vector of jobs to be executed.
+             *
+             * @return the vector of results of the jobs.
+             */
+            vector< BitBatchResult > extract( const vector< BitBatchJob >& jobs ) const;
+
             /**
              * @brief Tests the given archive without extracting its content.
              *
@@ -130,6 +304,22 @@ namespace bit7z {
             void test( const wstring& in_file ) const;
 
         private:
+            uint32_t mThreadsCount;
+            shared_ptr< BitBlockCache > mBlockCache;
+            shared_ptr< BitArchivePool > mArchivePool;
+
+            shared_ptr< BitInputArchive > openArchive( const wstring& in_file ) const;
+
+            void extractBlockToCache( const BitInputArchive& in_archive,
+                                      const BitBlockCache::ArchiveId& archive_id,
+                                      vector< byte_t >& out_buffer,
+                                      unsigned int index ) const;
+
+            void extractToDirectory( const BitInputArchive& in_archive,
+                                     const wstring& in_file,
+                                     const wstring& out_dir,
+                                     const vector< uint32_t >& indices ) const;
+
             void extractMatchingFilter( const wstring& in_file,
                                         const wstring& out_dir,
                                         const function< bool( const wstring& ) >& filter ) const;
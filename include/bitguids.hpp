@@ -42,6 +42,7 @@ namespace bit7z {
     extern "C" const GUID IID_ISetProperties;
     extern "C" const GUID IID_IInArchive;
     extern "C" const GUID IID_IOutArchive;
+    extern "C" const GUID IID_IInArchiveGetStream;
     extern "C" const GUID IID_IArchiveExtractCallback;
     extern "C" const GUID IID_IArchiveOpenVolumeCallback;
     extern "C" const GUID IID_IArchiveOpenSetSubArchiveName;
@@ -2,12 +2,15 @@
 #define BITINPUTARCHIVE_H
 
 #include "../include/bitarchivehandler.hpp"
+#include "../include/bititemreader.hpp"
 #include "../include/bitformat.hpp"
 #include "../include/bitpropvariant.hpp"
 #include "../include/bittypes.hpp"
 
 #include <vector>
 #include <string>
+#include <memory>
+#include <mutex>
 #include <cstdint>
 
 struct IInStream;
@@ -18,8 +21,11 @@ struct IArchiveExtractCallback;
 namespace bit7z {
     using std::wstring;
     using std::vector;
+    using std::unique_ptr;
 
     class ExtractCallback;
+    class ItemsCache;
+    class ItemsPathIndex;
 
     class BitInputArchive {
         public:
@@ -27,6 +33,8 @@ namespace bit7z {
 
             BitInputArchive( const BitArchiveHandler& handler, const vector< byte_t >& in_buffer );
 
+            BitInputArchive( const BitArchiveHandler& handler, const byte_t* in_buffer, size_t in_buffer_size );
+
             BitInputArchive( const BitArchiveHandler& handler, std::istream& in_stream );
 
             virtual ~BitInputArchive();
@@ -75,10 +83,89 @@ namespace bit7z {
              */
             bool isItemEncrypted( uint32_t index ) const;
 
+            /**
+             * @param index the index of an item in the archive.
+             *
+             * @return the path of the item at index (an empty string if the item has no path).
+             */
+            wstring itemPath( uint32_t index ) const;
+
+            /**
+             * @brief Gets the size of an item as declared by the archive, if it is plausible.
+             *
+             * Since the declared size of an item could be wrong (or crafted), it is considered plausible only if it
+             * is not too large with respect to the packed size of the item (when the latter is known).
+             *
+             * @param index the index of an item in the archive.
+             *
+             * @return the declared size of the item, or 0 if it is unknown or implausible.
+             */
+            uint64_t plausibleItemSize( uint32_t index ) const;
+
+            /**
+             * @brief Reads and caches the main properties (path, folder and encryption flags, sizes, modification
+             * time, attributes, CRC and solid block) of all the archive items, so that subsequent accesses to them do not need
+             * to query the archive.
+             *
+             * @note Calling this method when the properties are already cached has no effect.
+             */
+            void cacheItemsProperties();
+
+            /**
+             * @return true if and only if the main properties of the archive items are cached.
+             */
+            bool hasCachedItemsProperties() const;
+
+            /**
+             * @brief Searches the item having the given path in the archive.
+             *
+             * Both '/' and '\\' are considered as path separators, and leading, trailing and repeated separators
+             * are ignored (e.g. "dir/file.txt" and "\\dir\\file.txt" are the same path).
+             *
+             * @note The first search builds an index of the paths of all the archive items (one for case sensitive
+             * searches and one for case insensitive ones), so that subsequent searches take constant time.
+             *
+             * @note If more items have the same path, the index of the last one is returned.
+             *
+             * @param path              the path (in the archive) of the item to be searched.
+             * @param index             the index of the found item.
+             * @param case_sensitive    if false, the path is searched ignoring the case of its characters.
+             *
+             * @return true if and only if an item with the given path was found.
+             */
+            bool findItem( const wstring& path, uint32_t& index, bool case_sensitive = true ) const;
+
+            /**
+             * @brief Opens the specified item for reading its content as a stream of bytes.
+             *
+             * @note The item is decoded in the background while its content is being read, see BitItemReader.
+             *
+             * @param index         the index of the item (a file) in the archive.
+             * @param buffer_size   the size of the buffer containing the decoded data not read yet.
+             *
+             * @return the reader of the item content.
+             */
+            unique_ptr< BitItemReader > openItemReader( uint32_t index, size_t buffer_size = 1024 * 1024 ) const;
+
+            /**
+             * @brief Reads the specified range of bytes of the content of an item.
+             *
+             * @note If the archive format allows to access directly the content of the item (e.g. files in tar
+             * archives), the bytes are read directly from the archive at the corresponding offset. Otherwise, the
+             * item is decoded until the end of the range, discarding the bytes preceding it.
+             *
+             * @param index         the index of the item (a file) in the archive.
+             * @param offset        the offset (in the item content) of the first byte to be read.
+             * @param length        the maximum number of bytes to be read.
+             * @param out_buffer    the buffer where the read bytes will be put (it contains less than length bytes
+             *                      if the end of the item is reached before the end of the range).
+             */
+            void readRange( uint32_t index, uint64_t offset, size_t length, vector< byte_t >& out_buffer ) const;
+
         protected:
             IInArchive* openArchiveStream( const BitArchiveHandler& handler,
                                            const wstring& name,
-                                           IInStream* in_stream );
+                                           IInStream* in_stream ) const;
 
             HRESULT initUpdatableArchive( IOutArchive** newArc ) const;
 
@@ -93,10 +180,36 @@ namespace bit7z {
             friend class BitMemExtractor;
             friend class BitStreamExtractor;
             friend class BitArchiveCreator;
+            friend class BitItemReader;
+            friend class BitExtractionScheduler;
+            friend class BitArchivePool;
 
         private:
-            IInArchive* mInArchive;
-            const BitInFormat* mDetectedFormat;
+            const BitArchiveHandler* mHandler;
+            mutable IInArchive* mInArchive; // null until needed, if the items were loaded from a sidecar index
+            mutable std::once_flag mOpenFlag; // guards the (lazy) opening of mInArchive
+            mutable const BitInFormat* mDetectedFormat;
+            mutable bool mEncryptedHeaders; // true if a password was needed to open the archive
+            unique_ptr< ItemsCache > mItemsCache;
+            wstring mArchivePath;
+
+            // Indices of the items paths, built (once) by the first search, then searched without locking
+            mutable std::once_flag mPathIndexFlag;
+            mutable unique_ptr< ItemsPathIndex > mPathIndex;
+            mutable std::once_flag mCaseInsensitivePathIndexFlag;
+            mutable unique_ptr< ItemsPathIndex > mCaseInsensitivePathIndex;
+
+            bool useSidecarIndex( const BitArchiveHandler& handler ) const;
+
+            bool loadSidecarIndex( const BitArchiveHandler& handler );
+
+            void openArchiveFile() const;
+
+            IInArchive* inArchive() const;
+
+            void applyHandlerOptions( const BitArchiveHandler& handler );
+
+            void setHandler( const BitArchiveHandler& handler );
     };
 }
 
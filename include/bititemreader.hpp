@@ -0,0 +1,106 @@
+/*
+ * bit7z - A C++ static library to interface with the 7-zip DLLs.
+ * Copyright (c) 2014-2019  Riccardo Ostani - All Rights Reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * Bit7z is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with bit7z; if not, see https://www.gnu.org/licenses/.
+ */
+
+#ifndef BITITEMREADER_HPP
+#define BITITEMREADER_HPP
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+#include <cstdint>
+
+#include "../include/bittypes.hpp"
+
+namespace bit7z {
+    using std::vector;
+
+    class BitArchiveHandler;
+    class BitInputArchive;
+
+    /**
+     * @brief The BitItemReader class allows to read the content of an archive item as a stream of bytes.
+     *
+     * The item is decoded by a producer thread into a bounded ring buffer, from which the read method pulls the
+     * decoded data: hence, the memory used does not depend on the size of the item, and the decoding of the item
+     * overlaps with the processing of the read data.
+     *
+     * @note The BitInputArchive object that opened the reader (as well as its archive handler) must outlive the
+     * reader, and it must not be used for other operations while the reader is alive. The callbacks of the archive
+     * handler are called by the producer thread.
+     */
+    class BitItemReader {
+        public:
+            /**
+             * @brief BitItemReader destructor.
+             *
+             * @note If the item has not been read completely, its decoding is stopped.
+             */
+            virtual ~BitItemReader();
+
+            /**
+             * @return the index (in the archive) of the item being read.
+             */
+            uint32_t index() const;
+
+            /**
+             * @brief Reads the next bytes of the item content, waiting for them to be decoded if necessary.
+             *
+             * If an error occurs while decoding the item, a BitException is thrown (once all the data decoded
+             * before the error has been read).
+             *
+             * @param buffer    the buffer where the read bytes will be put.
+             * @param size      the maximum number of bytes to be read.
+             *
+             * @return the number of bytes read (0 if and only if the end of the item has been reached or size is 0).
+             */
+            size_t read( byte_t* buffer, size_t size );
+
+        private:
+            class ProducerVisitor;
+
+            uint32_t mIndex;
+
+            // Ring buffer shared with the producer thread
+            vector< byte_t > mBuffer;
+            size_t mReadPosition;
+            size_t mAvailable;
+            bool mProducerDone;
+            bool mCancelled;
+            std::exception_ptr mError;
+            std::mutex mMutex;
+            std::condition_variable mDataAvailable;
+            std::condition_variable mSpaceAvailable;
+
+            std::thread mProducer;
+
+            BitItemReader( const BitArchiveHandler& handler,
+                           const BitInputArchive& in_archive,
+                           uint32_t index,
+                           size_t buffer_size );
+
+            void produce( const BitArchiveHandler& handler, const BitInputArchive& in_archive );
+
+            bool write( const byte_t* data, size_t size );
+
+            friend class BitInputArchive;
+    };
+}
+
+#endif // BITITEMREADER_HPP
@@ -85,6 +85,55 @@ namespace bit7z {
             void compress( const vector< byte_t >& in_buffer,
                            ostream& out_stream,
                            const wstring& in_buffer_name = L"" ) const;
+
+            /**
+             * @brief Compresses the given memory region to an archive on the filesystem.
+             *
+             * @note The memory region is not copied.
+             *
+             * @param in_buffer         the pointer to the memory region to be compressed.
+             * @param in_buffer_size    the size of the memory region.
+             * @param out_file          the output archive path.
+             * @param in_buffer_name    (optional) the buffer name used to give a name to the content of the archive.
+             */
+            void compress( const byte_t* in_buffer,
+                           size_t in_buffer_size,
+                           const wstring& out_file,
+                           const wstring& in_buffer_name = L"" ) const;
+
+            /**
+             * @brief Compresses the given memory region to the output buffer.
+             *
+             * @note The memory region is not copied.
+             *
+             * @note If the format of the output doesn't support in memory compression, a BitException is thrown.
+             *
+             * @param in_buffer         the pointer to the memory region to be compressed.
+             * @param in_buffer_size    the size of the memory region.
+             * @param out_buffer        the buffer going to contain the output archive.
+             * @param in_buffer_name    (optional) the buffer name used to give a name to the content of the archive.
+             */
+            void compress( const byte_t* in_buffer,
+                           size_t in_buffer_size,
+                           vector< byte_t >& out_buffer,
+                           const wstring& in_buffer_name = L"" ) const;
+
+            /**
+             * @brief Compresses the given memory region to the output standard stream.
+             *
+             * @note The memory region is not copied.
+             *
+             * @note If the format of the output doesn't support in memory compression, a BitException is thrown.
+             *
+             * @param in_buffer         the pointer to the memory region to be compressed.
+             * @param in_buffer_size    the size of the memory region.
+             * @param out_stream        the (binary) stream going to contain the output archive.
+             * @param in_buffer_name    (optional) the buffer name used to give a name to the content of the archive.
+             */
+            void compress( const byte_t* in_buffer,
+                           size_t in_buffer_size,
+                           ostream& out_stream,
+                           const wstring& in_buffer_name = L"" ) const;
     };
 }
 #endif // BITMEMCOMPRESSOR_HPP
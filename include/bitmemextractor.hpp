@@ -20,6 +20,8 @@
 #define BITMEMEXTRACTOR_HPP
 
 #include "../include/bitarchiveopener.hpp"
+#include "../include/bitarenamap.hpp"
+#include "../include/bitchunkvisitor.hpp"
 #include "../include/bittypes.hpp"
 
 namespace bit7z {
@@ -82,6 +84,27 @@ namespace bit7z {
              */
             void extract( const vector< byte_t >& in_buffer, map< wstring, vector< byte_t > >& out_map ) const;
 
+            /**
+             * @brief Extracts the content of the given buffer archive into a single memory arena, where the contents of
+             * all the files are stored contiguously and indexed by their paths (inside the archive).
+             *
+             * @note The arena is sized from the total unpacked size of the files, so that the number of memory
+             * allocations does not depend on the number of extracted files.
+             *
+             * @param in_buffer   the buffer containing the archive to be extracted.
+             * @param out_arena   the output arena map.
+             */
+            void extract( const vector< byte_t >& in_buffer, BitArenaMap& out_arena ) const;
+
+            /**
+             * @brief Extracts the content of the given buffer archive, passing each decoded chunk of the files to the
+             * given visitor, without buffering it.
+             *
+             * @param in_buffer   the buffer containing the archive to be extracted.
+             * @param visitor     the visitor receiving the content of the files.
+             */
+            void extract( const vector< byte_t >& in_buffer, BitChunkVisitor& visitor ) const;
+
             /**
              * @brief Tests the given buffer archive without extracting its content.
              *
@@ -90,6 +113,98 @@ namespace bit7z {
              * @param in_buffer    the buffer containing the archive to be tested.
              */
             void test( const vector< byte_t >& in_buffer ) const;
+
+            /**
+             * @brief Extracts the archive in the given memory region into the choosen directory.
+             *
+             * @note The memory region is not copied.
+             *
+             * @param in_buffer         the pointer to the memory region containing the archive to be extracted.
+             * @param in_buffer_size    the size of the memory region.
+             * @param out_dir           the output directory where to put the file extracted.
+             */
+            void extract( const byte_t* in_buffer, size_t in_buffer_size, const wstring& out_dir = L"" ) const;
+
+            /**
+             * @brief Extracts the archive in the given memory region into the output buffer.
+             *
+             * @note The memory region is not copied.
+             *
+             * @param in_buffer         the pointer to the memory region containing the archive to be extracted.
+             * @param in_buffer_size    the size of the memory region.
+             * @param out_buffer        the output buffer where the content of the archive will be put.
+             * @param index             the index of the file to be extracted from in_buffer.
+             */
+            void extract( const byte_t* in_buffer,
+                          size_t in_buffer_size,
+                          vector< byte_t >& out_buffer,
+                          unsigned int index = 0 ) const;
+
+            /**
+             * @brief Extracts the archive in the given memory region into the output standard stream.
+             *
+             * @note The memory region is not copied.
+             *
+             * @param in_buffer         the pointer to the memory region containing the archive to be extracted.
+             * @param in_buffer_size    the size of the memory region.
+             * @param out_stream        the (binary) stream where the content of the archive will be put.
+             * @param index             the index of the file to be extracted from in_buffer.
+             */
+            void extract( const byte_t* in_buffer,
+                          size_t in_buffer_size,
+                          ostream& out_stream,
+                          unsigned int index = 0 ) const;
+
+            /**
+             * @brief Extracts the archive in the given memory region into a map of memory buffers, where keys are the
+             * paths of the files (inside the archive) and values are the corresponding decompressed contents.
+             *
+             * @note The memory region is not copied.
+             *
+             * @param in_buffer         the pointer to the memory region containing the archive to be extracted.
+             * @param in_buffer_size    the size of the memory region.
+             * @param out_map           the output map.
+             */
+            void extract( const byte_t* in_buffer,
+                          size_t in_buffer_size,
+                          map< wstring, vector< byte_t > >& out_map ) const;
+
+            /**
+             * @brief Extracts the content of the archive in the given memory region into a single memory arena, where the contents of
+             * all the files are stored contiguously and indexed by their paths (inside the archive).
+             *
+             * @note The arena is sized from the total unpacked size of the files, so that the number of memory
+             * allocations does not depend on the number of extracted files.
+             *
+             * @note The memory region is not copied.
+             *
+             * @param in_buffer         the pointer to the memory region containing the archive to be extracted.
+             * @param in_buffer_size    the size of the memory region.
+             * @param out_arena         the output arena map.
+             */
+            void extract( const byte_t* in_buffer, size_t in_buffer_size, BitArenaMap& out_arena ) const;
+
+            /**
+             * @brief Extracts the content of the archive in the given memory region, passing each decoded chunk of
+             * the files to the given visitor, without buffering it.
+             *
+             * @note The memory region is not copied.
+             *
+             * @param in_buffer         the pointer to the memory region containing the archive to be extracted.
+             * @param in_buffer_size    the size of the memory region.
+             * @param visitor           the visitor receiving the content of the files.
+             */
+            void extract( const byte_t* in_buffer, size_t in_buffer_size, BitChunkVisitor& visitor ) const;
+
+            /**
+             * @brief Tests the archive in the given memory region without extracting its content.
+             *
+             * If the input archive is not valid, a BitException is thrown.
+             *
+             * @param in_buffer         the pointer to the memory region containing the archive to be tested.
+             * @param in_buffer_size    the size of the memory region.
+             */
+            void test( const byte_t* in_buffer, size_t in_buffer_size ) const;
     };
 }
 
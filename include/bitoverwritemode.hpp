@@ -0,0 +1,35 @@
+/*
+ * bit7z - A C++ static library to interface with the 7-zip DLLs.
+ * Copyright (c) 2014-2019  Riccardo Ostani - All Rights Reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * Bit7z is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with bit7z; if not, see https://www.gnu.org/licenses/.
+ */
+
+#ifndef BITOVERWRITEMODE_HPP
+#define BITOVERWRITEMODE_HPP
+
+namespace bit7z {
+    /**
+     * @brief The BitOverwriteMode enum represents how the extraction of an item behaves when the output file already
+     * exists on the file system.
+     */
+    enum class BitOverwriteMode {
+        OVERWRITE,        ///< The existing file is overwritten
+        SKIP,             ///< The existing file is kept, and the item is not extracted
+        RENAME,           ///< The item is extracted to a new file, named as the existing one plus a numeric suffix
+        SKIP_IF_IDENTICAL ///< The item is not extracted if the existing file has its same size and modification time
+    };
+}
+
+#endif // BITOVERWRITEMODE_HPP
@@ -20,6 +20,8 @@
 #define BITSTREAMEXTRACTOR_HPP
 
 #include "../include/bitarchiveopener.hpp"
+#include "../include/bitarenamap.hpp"
+#include "../include/bitchunkvisitor.hpp"
 #include "../include/bittypes.hpp"
 
 namespace bit7z {
@@ -82,6 +84,27 @@ namespace bit7z {
              */
             void extract( istream& in_stream, map< wstring, vector< byte_t > >& out_map ) const;
 
+            /**
+             * @brief Extracts the content of the given stream archive into a single memory arena, where the contents of
+             * all the files are stored contiguously and indexed by their paths (inside the archive).
+             *
+             * @note The arena is sized from the total unpacked size of the files, so that the number of memory
+             * allocations does not depend on the number of extracted files.
+             *
+             * @param in_stream   the (binary) stream containing the archive to be extracted.
+             * @param out_arena   the output arena map.
+             */
+            void extract( istream& in_stream, BitArenaMap& out_arena ) const;
+
+            /**
+             * @brief Extracts the content of the given stream archive, passing each decoded chunk of the files to the
+             * given visitor, without buffering it.
+             *
+             * @param in_stream   the (binary) stream containing the archive to be extracted.
+             * @param visitor     the visitor receiving the content of the files.
+             */
+            void extract( istream& in_stream, BitChunkVisitor& visitor ) const;
+
             /**
              * @brief Tests the given stream archive without extracting its content.
              *
@@ -33,7 +33,8 @@ namespace bit7z {
     class BufferUpdateCallback : public UpdateCallback {
         public:
             BufferUpdateCallback( const BitArchiveCreator& creator,
-                                  const vector< byte_t >& in_buffer,
+                                  const byte_t* in_buffer,
+                                  size_t in_buffer_size,
                                   const wstring& in_buffer_name );
 
             virtual ~BufferUpdateCallback() override;
@@ -47,7 +48,8 @@ namespace bit7z {
             uint32_t itemsCount() const override;
 
         private:
-            const vector< byte_t >& mBuffer;
+            const byte_t* mBuffer;
+            size_t mBufferSize;
             const wstring& mBufferName;
     };
 }
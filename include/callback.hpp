@@ -36,6 +36,7 @@ CONSTEXPR auto kCRCFailed         = L"CRC Failed";
 CONSTEXPR auto kDataError         = L"Data Error";
 CONSTEXPR auto kUnknownError      = L"Unknown Error";
 CONSTEXPR auto kEmptyFileAlias    = L"[Content]";
+CONSTEXPR auto kOperationAborted  = L"Operation aborted";
 
 namespace bit7z {
     using std::wstring;
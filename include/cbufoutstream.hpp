@@ -20,6 +20,7 @@
 #define CBUFOUTSTREAM_HPP
 
 #include <vector>
+#include <cstdint>
 
 #include "../include/bittypes.hpp"
 
@@ -40,6 +41,11 @@ namespace bit7z {
             // ISequentialOutStream
             STDMETHOD( Write )( const void* data, UInt32 size, UInt32* processedSize );
 
+            /* Reserves the capacity of the buffer for a content of the given (plausible) size, so that it can be
+             * written using a single allocation. Allocation failures are ignored: the buffer will grow as the content
+             * is being written. */
+            static void reserveBuffer( vector< byte_t >& buffer, uint64_t size );
+
         private:
             vector< byte_t >& mBuffer;
     };
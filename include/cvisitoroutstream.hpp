@@ -0,0 +1,51 @@
+/*
+ * bit7z - A C++ static library to interface with the 7-zip DLLs.
+ * Copyright (c) 2014-2019  Riccardo Ostani - All Rights Reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * Bit7z is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with bit7z; if not, see https://www.gnu.org/licenses/.
+ */
+
+#ifndef CVISITOROUTSTREAM_HPP
+#define CVISITOROUTSTREAM_HPP
+
+#include <exception>
+
+#include "../include/bitchunkvisitor.hpp"
+
+#include "7zip/IStream.h"
+#include "Common/MyCom.h"
+
+namespace bit7z {
+    class CVisitorOutStream : public ISequentialOutStream, public CMyUnknownImp {
+        public:
+            CVisitorOutStream( BitChunkVisitor& visitor,
+                               uint32_t index,
+                               bool& aborted,
+                               std::exception_ptr& visitor_exception );
+
+            virtual ~CVisitorOutStream();
+
+            MY_UNKNOWN_IMP1( ISequentialOutStream )
+
+            // ISequentialOutStream
+            STDMETHOD( Write )( const void* data, UInt32 size, UInt32* processedSize );
+
+        private:
+            BitChunkVisitor& mVisitor;
+            uint32_t mIndex;
+            bool& mAborted;
+            std::exception_ptr& mVisitorException; // exception thrown by the visitor, which aborted the extraction
+    };
+}
+#endif // CVISITOROUTSTREAM_HPP
@@ -0,0 +1,60 @@
+/*
+ * bit7z - A C++ static library to interface with the 7-zip DLLs.
+ * Copyright (c) 2014-2019  Riccardo Ostani - All Rights Reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * Bit7z is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with bit7z; if not, see https://www.gnu.org/licenses/.
+ */
+
+#ifndef CWRITEBEHINDOUTSTREAM_HPP
+#define CWRITEBEHINDOUTSTREAM_HPP
+
+#include <vector>
+#include <memory>
+
+#include "../include/bittypes.hpp"
+#include "../include/writebehindqueue.hpp"
+
+#include "7zip/IStream.h"
+#include "Common/MyCom.h"
+
+namespace bit7z {
+    using std::vector;
+    using std::shared_ptr;
+
+    /* Output stream collecting the written data in chunks, which are then written to the output file by the
+     * writer threads of a WriteBehindQueue */
+    class CWriteBehindOutStream : public ISequentialOutStream, public CMyUnknownImp {
+        public:
+            CWriteBehindOutStream( WriteBehindQueue& queue,
+                                   COutFileStream* file_stream_spec,
+                                   const wstring& path,
+                                   uint64_t preallocated_size );
+
+            virtual ~CWriteBehindOutStream();
+
+            // Flushes the data not queued yet, and queues the closing of the file (and the setting of its metadata)
+            HRESULT Close( const FILETIME* mtime, const UInt32* attrib );
+
+            MY_UNKNOWN_IMP1( ISequentialOutStream )
+
+            // ISequentialOutStream
+            STDMETHOD( Write )( const void* data, UInt32 size, UInt32* processedSize );
+
+        private:
+            WriteBehindQueue& mQueue;
+            shared_ptr< WriteBehindQueue::File > mFile;
+            vector< byte_t > mChunk;
+    };
+}
+#endif // CWRITEBEHINDOUTSTREAM_HPP
@@ -0,0 +1,65 @@
+/*
+ * bit7z - A C++ static library to interface with the 7-zip DLLs.
+ * Copyright (c) 2014-2019  Riccardo Ostani - All Rights Reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * Bit7z is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with bit7z; if not, see https://www.gnu.org/licenses/.
+ */
+
+#ifndef DEFERREDMETADATA_HPP
+#define DEFERREDMETADATA_HPP
+
+#include <vector>
+#include <string>
+#include <mutex>
+#include <cstdint>
+
+#include "7zip/Common/FileStreams.h"
+
+namespace bit7z {
+    using std::vector;
+    using std::wstring;
+
+    /* Metadata (modification time and attributes) of the extracted items, recorded during the extraction and applied
+     * all at once at its end, so that the decoding thread does not perform the related system calls.
+     * Folders are processed after all the files, from the deepest to the outermost, so that their modification times
+     * are not changed by the creation of the items they contain. */
+    class DeferredMetadata {
+        public:
+            DeferredMetadata();
+
+            void addFile( const wstring& path, const FILETIME* mtime, const uint32_t* attrib );
+
+            void addDirectory( const wstring& path, const FILETIME* mtime, const uint32_t* attrib );
+
+            void apply();
+
+        private:
+            struct Entry {
+                wstring path;
+                bool mtimeDefined;
+                FILETIME mtime;
+                bool attribDefined;
+                uint32_t attrib;
+            };
+
+            std::mutex mMutex; // items may be added by several decoding threads
+            vector< Entry > mFiles;
+            vector< Entry > mDirectories;
+
+            static Entry makeEntry( const wstring& path, const FILETIME* mtime, const uint32_t* attrib );
+
+            static void applyEntry( const Entry& entry );
+    };
+}
+#endif // DEFERREDMETADATA_HPP
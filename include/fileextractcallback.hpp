@@ -20,21 +20,28 @@
 #define FILEEXTRACTCALLBACK_HPP
 
 #include <string>
+#include <unordered_set>
 
 #include "7zip/Common/FileStreams.h"
 
+#include "../include/bitarchiveopener.hpp"
 #include "../include/bitguids.hpp"
+#include "../include/cwritebehindoutstream.hpp"
+#include "../include/deferredmetadata.hpp"
 #include "../include/extractcallback.hpp"
 
 namespace bit7z {
     using std::wstring;
+    using std::unordered_set;
 
     class FileExtractCallback : public ExtractCallback {
         public:
-            FileExtractCallback( const BitArchiveHandler& handler,
+            FileExtractCallback( const BitArchiveOpener& opener,
                                  const BitInputArchive& inputArchive,
                                  const wstring& inFilePath,
-                                 const wstring& directoryPath );
+                                 const wstring& directoryPath,
+                                 WriteBehindQueue* writeBehindQueue = nullptr,
+                                 DeferredMetadata* deferredMetadata = nullptr );
 
             virtual ~FileExtractCallback() override;
 
@@ -47,6 +54,10 @@ namespace bit7z {
             wstring mDirectoryPath;  // Output directory
             wstring mFilePath;       // name inside archive
             wstring mDiskFilePath;   // full path to file on disk
+            BitOverwriteMode mOverwriteMode;
+            bool mCrcComparison;
+            UInt64 mPreallocationThreshold;
+            UInt64 mPreallocatedSize; // 0 if the current output file was not preallocated
 
             struct CProcessedFileInfo {
                 FILETIME MTime;
@@ -57,7 +68,21 @@ namespace bit7z {
             } mProcessedFileInfo;
 
             COutFileStream* mOutFileStreamSpec;
+            CWriteBehindOutStream* mWriteBehindStreamSpec; // non null if the file is written by the writer threads
             CMyComPtr< ISequentialOutStream > mOutFileStream;
+            WriteBehindQueue* mWriteBehindQueue;
+            DeferredMetadata* mDeferredMetadata; // non null if the metadata is applied at the end of the extraction
+
+            // Folders (relative to the output directory) already created during the current extraction
+            unordered_set< wstring > mCreatedDirectories;
+
+            void createDirectory( const wstring& dir_path );
+
+            UInt64 preallocationSize( UInt32 index, const wstring& file_path ) const;
+
+            void closeAbortedFile();
+
+            bool isIdenticalFile( UInt32 index, UInt64 file_size, const FILETIME& file_mtime ) const;
     };
 }
 #endif // FILEEXTRACTCALLBACK_HPP
@@ -24,6 +24,7 @@
 #include <map>
 
 #include "../include/fsitem.hpp"
+#include "../include/wildcardpattern.hpp"
 
 namespace bit7z {
     namespace filesystem {
@@ -45,6 +46,7 @@ namespace bit7z {
             private:
                 FSItem mDirItem;
                 wstring mFilter;
+                WildcardPattern mFilterPattern;
 
                 explicit FSIndexer( const wstring& directory, const wstring& filter = L"" );
 
@@ -20,6 +20,7 @@
 #define FSUTIL_HPP
 
 #include <string>
+#include <cstdint>
 
 namespace bit7z {
     namespace filesystem {
@@ -43,6 +44,8 @@ namespace bit7z {
             wstring extension( const wstring& path );
 
             bool wildcardMatch( const wstring& pattern, const wstring& str );
+
+            bool getFileStamp( const wstring& path, uint64_t& size, uint64_t& last_write_time );
         }
     }
 }
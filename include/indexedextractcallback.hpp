@@ -0,0 +1,61 @@
+/*
+ * bit7z - A C++ static library to interface with the 7-zip DLLs.
+ * Copyright (c) 2014-2019  Riccardo Ostani - All Rights Reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * Bit7z is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with bit7z; if not, see https://www.gnu.org/licenses/.
+ */
+
+#ifndef INDEXEDEXTRACTCALLBACK_HPP
+#define INDEXEDEXTRACTCALLBACK_HPP
+
+#include <vector>
+#include <utility>
+
+#include "../include/bittypes.hpp"
+#include "../include/extractcallback.hpp"
+
+namespace bit7z {
+    using std::vector;
+    using std::pair;
+
+    /* Extracts the items to the buffers of the given vector: each slot is a pair (index of the item in the archive,
+     * position of its buffer in buffers), and the slots are sorted by item index (items having no slot, if any, are
+     * not extracted) */
+    class IndexedExtractCallback : public ExtractCallback {
+        public:
+            typedef pair< uint32_t, uint32_t > Slot;
+
+            static const uint32_t kNoSlot = static_cast< uint32_t >( -1 );
+
+            IndexedExtractCallback( const BitArchiveHandler& handler,
+                                    const BitInputArchive& inputArchive,
+                                    const vector< Slot >& slots,
+                                    vector< vector< byte_t > >& buffers );
+
+            // Returns the position of the buffer of the item at the given index (kNoSlot if the item has no slot)
+            static uint32_t findSlot( const vector< Slot >& slots, uint32_t index );
+
+            virtual ~IndexedExtractCallback();
+
+            // IArchiveExtractCallback
+            STDMETHOD( GetStream )( UInt32 index, ISequentialOutStream** outStream, Int32 askExtractMode );
+            STDMETHOD( SetOperationResult )( Int32 resultEOperationResult );
+
+        private:
+            const vector< Slot >& mSlots;
+            vector< vector< byte_t > >& mBuffers;
+            CMyComPtr< ISequentialOutStream > mOutMemStream;
+    };
+}
+#endif // INDEXEDEXTRACTCALLBACK_HPP
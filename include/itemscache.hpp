@@ -0,0 +1,88 @@
+/*
+ * bit7z - A C++ static library to interface with the 7-zip DLLs.
+ * Copyright (c) 2014-2019  Riccardo Ostani - All Rights Reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * Bit7z is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with bit7z; if not, see https://www.gnu.org/licenses/.
+ */
+
+#ifndef ITEMSCACHE_HPP
+#define ITEMSCACHE_HPP
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <cstdint>
+
+#include "../include/bitpropvariant.hpp"
+
+struct IInArchive;
+
+namespace bit7z {
+    using std::vector;
+    using std::wstring;
+    using std::unique_ptr;
+
+    /* Column-oriented copy of the most used properties of all the items of an archive.
+     * All the values are read in a single pass when the cache is built; afterwards, any access is a plain array read
+     * (i.e. no calls to the IInArchive object and, except for the paths, no PROPVARIANT allocations). */
+    class ItemsCache {
+        public:
+            explicit ItemsCache( IInArchive* in_archive );
+
+            uint32_t itemsCount() const;
+
+            static bool isCached( BitProperty property );
+
+            BitPropVariant itemProperty( uint32_t index, BitProperty property ) const;
+
+            wstring itemPath( uint32_t index ) const;
+
+            bool isItemFolder( uint32_t index ) const;
+
+            bool isItemEncrypted( uint32_t index ) const;
+
+            /* Sidecar index files: the columns are stored as they are (largest elements first, so that each column
+             * is naturally aligned), preceded by a header identifying the archive file they were read from */
+            static unique_ptr< ItemsCache > loadIndexFile( const wstring& index_file,
+                                                           const wstring& archive_file,
+                                                           int& format_value );
+
+            bool saveIndexFile( const wstring& index_file, const wstring& archive_file, int format_value ) const;
+
+        private:
+            uint32_t mItemsCount;
+
+            // Paths are stored contiguously in a single pool: the i-th path spans [mPathsOffsets[i], mPathsOffsets[i+1])
+            vector< wchar_t > mPathsPool;
+            vector< uint32_t > mPathsOffsets;
+
+            vector< uint64_t > mSizes;
+            vector< uint64_t > mPackSizes;
+            vector< FILETIME > mMTimes;
+            vector< uint64_t > mBlocks;
+            vector< uint32_t > mAttributes;
+            vector< uint32_t > mCRCs;
+
+            // For each item, which properties have a value (and the value of the boolean ones)
+            vector< uint16_t > mFlags;
+
+            ItemsCache();
+
+            bool hasFlag( uint32_t index, uint16_t flag ) const;
+
+            bool isConsistent() const;
+    };
+}
+
+#endif // ITEMSCACHE_HPP
@@ -0,0 +1,50 @@
+/*
+ * bit7z - A C++ static library to interface with the 7-zip DLLs.
+ * Copyright (c) 2014-2019  Riccardo Ostani - All Rights Reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * Bit7z is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with bit7z; if not, see https://www.gnu.org/licenses/.
+ */
+
+#ifndef ITEMSPATHINDEX_HPP
+#define ITEMSPATHINDEX_HPP
+
+#include <string>
+#include <unordered_map>
+#include <cstdint>
+
+namespace bit7z {
+    using std::wstring;
+    using std::unordered_map;
+
+    class BitInputArchive;
+
+    /* Hash index from the (normalized) paths of the items of an archive to their indices.
+     * Paths are normalized by using '\' as the only separator and by removing leading, trailing and repeated
+     * separators (so that, for example, "dir/file.txt", "dir\\file.txt" and "/dir//file.txt" are the same path);
+     * if the index is not case sensitive, paths are also converted to lower case. */
+    class ItemsPathIndex {
+        public:
+            ItemsPathIndex( const BitInputArchive& in_archive, bool case_sensitive );
+
+            bool find( const wstring& path, uint32_t& index ) const;
+
+            static wstring normalizePath( const wstring& path, bool case_sensitive );
+
+        private:
+            bool mCaseSensitive;
+            unordered_map< wstring, uint32_t > mIndices;
+    };
+}
+
+#endif // ITEMSPATHINDEX_HPP
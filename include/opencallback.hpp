@@ -58,8 +58,12 @@ namespace bit7z {
             //ICryptoGetTextPassword
             STDMETHOD( CryptoGetTextPassword )( BSTR* password );
 
+            // Returns true if a password was needed to open the archive (i.e. the archive headers are encrypted)
+            bool passwordRequested() const;
+
         private:
             bool mSubArchiveMode;
+            bool mPasswordRequested;
             wstring mSubArchiveName;
             FSItem mFileItem;
     };
@@ -0,0 +1,35 @@
+/*
+ * bit7z - A C++ static library to interface with the 7-zip DLLs.
+ * Copyright (c) 2014-2019  Riccardo Ostani - All Rights Reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * Bit7z is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with bit7z; if not, see https://www.gnu.org/licenses/.
+ */
+
+#ifndef PARALLELFOR_HPP
+#define PARALLELFOR_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <functional>
+
+namespace bit7z {
+    using std::function;
+
+    /* Runs task( i ) for each i in [0, tasks_count) using at most threads_count worker threads (0 means one thread for
+     * each hardware core). Tasks are handed out in order to the first idle worker. If a task throws, no further task is
+     * started and the first exception is rethrown on the calling thread after all the workers have finished. */
+    void parallelFor( size_t tasks_count, uint32_t threads_count, const function< void( size_t ) >& task );
+}
+
+#endif // PARALLELFOR_HPP
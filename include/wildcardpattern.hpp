@@ -0,0 +1,97 @@
+/*
+ * bit7z - A C++ static library to interface with the 7-zip DLLs.
+ * Copyright (c) 2014-2019  Riccardo Ostani - All Rights Reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * Bit7z is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with bit7z; if not, see https://www.gnu.org/licenses/.
+ */
+
+#ifndef WILDCARDPATTERN_HPP
+#define WILDCARDPATTERN_HPP
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+namespace bit7z {
+    namespace filesystem {
+        using std::wstring;
+        using std::vector;
+
+        /* Wildcard pattern compiled once into a sequence of tokens, so that it can be matched against many strings
+         * without parsing it again each time.
+         *
+         * Supported syntax:
+         *  - '?' matches any single character;
+         *  - '*' matches any sequence of characters (possibly empty);
+         *  - '**' matches any sequence of characters, including path separators (see below);
+         *  - '[abc]', '[a-z]' match any character in the set/range, '[!abc]' and '[^abc]' any character not in it,
+         *    but only if character sets are enabled: by default, '[' is a normal character (as it was for the
+         *    original fsutil::wildcardMatch function), since it is common in file names (e.g. "file[1].txt").
+         *
+         * By default, '*' and '?' match also path separators (i.e. '*' and '**' are equivalent); if the pattern is
+         * path aware, they do not, and only '**' can match across different path components.
+         *
+         * Matching is performed by simulating the (non deterministic) automaton of the pattern, i.e. without any
+         * backtracking or recursion: its cost is linear in the length of the string (times the number of tokens of
+         * the pattern in the worst case). */
+        class WildcardPattern {
+            public:
+                explicit WildcardPattern( const wstring& pattern,
+                                          bool case_sensitive = true,
+                                          bool path_aware = false,
+                                          bool char_sets = false );
+
+                bool matches( const wstring& str ) const;
+
+            private:
+                enum class TokenType : uint8_t {
+                    Char,
+                    AnyChar,
+                    AnyString,
+                    AnyPath,
+                    CharSet
+                };
+
+                struct Token {
+                    TokenType type;
+                    bool negated; // only for CharSet tokens
+                    wchar_t value; // only for Char tokens
+                    uint32_t rangesBegin; // only for CharSet tokens: the ranges of the set are in
+                    uint32_t rangesEnd;   // [mRanges.begin() + rangesBegin, mRanges.begin() + rangesEnd)
+                };
+
+                struct CharRange {
+                    wchar_t first;
+                    wchar_t last;
+                };
+
+                vector< Token > mTokens;
+                vector< CharRange > mRanges;
+                bool mCaseSensitive;
+                bool mPathAware;
+                uint64_t mStarsMask; // bit i is set if the i-th token is a star (only for the first 64 tokens)
+
+                void addToken( TokenType type, wchar_t value = L'\0' );
+
+                size_t parseCharSet( const wstring& pattern, size_t start );
+
+                bool inCharSet( const Token& token, wchar_t c ) const;
+
+                bool matchesChar( const Token& token, wchar_t c ) const;
+
+                bool matchesLongPattern( const wstring& str ) const;
+        };
+    }
+}
+#endif // WILDCARDPATTERN_HPP
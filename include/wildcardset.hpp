@@ -0,0 +1,60 @@
+/*
+ * bit7z - A C++ static library to interface with the 7-zip DLLs.
+ * Copyright (c) 2014-2019  Riccardo Ostani - All Rights Reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * Bit7z is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with bit7z; if not, see https://www.gnu.org/licenses/.
+ */
+
+#ifndef WILDCARDSET_HPP
+#define WILDCARDSET_HPP
+
+#include <string>
+#include <vector>
+#include <unordered_set>
+
+#include "../include/wildcardpattern.hpp"
+
+namespace bit7z {
+    namespace filesystem {
+        using std::wstring;
+        using std::vector;
+        using std::unordered_set;
+
+        /* Set of wildcard patterns matching a string if any of them does.
+         * Since large rule sets are mostly made of literal paths (e.g. "dir\file.txt"), prefixes (e.g. "dir\*") and
+         * suffixes (e.g. "*.txt"), such patterns are grouped in hash sets, so that the cost of matching them depends
+         * on the number of their distinct lengths rather than on their number. Only the remaining patterns are
+         * matched one by one. */
+        class WildcardSet {
+            public:
+                explicit WildcardSet( const vector< wstring >& patterns, bool case_sensitive = true );
+
+                bool empty() const;
+
+                bool matches( const wstring& str ) const;
+
+            private:
+                bool mCaseSensitive;
+                bool mEmpty;
+                bool mMatchesAll;
+                unordered_set< wstring > mLiterals;
+                unordered_set< wstring > mPrefixes;
+                unordered_set< wstring > mSuffixes;
+                vector< size_t > mPrefixesLengths; // distinct lengths of the prefixes, in ascending order
+                vector< size_t > mSuffixesLengths; // distinct lengths of the suffixes, in ascending order
+                vector< WildcardPattern > mPatterns;
+        };
+    }
+}
+#endif // WILDCARDSET_HPP
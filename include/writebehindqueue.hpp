@@ -0,0 +1,111 @@
+/*
+ * bit7z - A C++ static library to interface with the 7-zip DLLs.
+ * Copyright (c) 2014-2019  Riccardo Ostani - All Rights Reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * Bit7z is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with bit7z; if not, see https://www.gnu.org/licenses/.
+ */
+
+#ifndef WRITEBEHINDQUEUE_HPP
+#define WRITEBEHINDQUEUE_HPP
+
+#include <vector>
+#include <deque>
+#include <string>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cstdint>
+
+#include "../include/bittypes.hpp"
+
+#include "7zip/Common/FileStreams.h"
+
+namespace bit7z {
+    using std::vector;
+    using std::deque;
+    using std::wstring;
+    using std::shared_ptr;
+    using std::unique_ptr;
+
+    /* Pool of writer threads performing the writes (and the closing) of the files being extracted, so that the
+     * decoding thread does not have to wait for them.
+     * The writes of each file are ordered, since each file is assigned to a single writer thread; the total size of
+     * the data queued and not written yet is limited to a memory budget, after which the producers wait.
+     * A queue can be shared by several decoding threads (e.g. the workers of a parallel extraction). */
+    class WriteBehindQueue {
+        public:
+            struct File {
+                CMyComPtr< IOutStream > stream;
+                COutFileStream* streamSpec;
+                wstring path;
+                size_t writer;
+                uint64_t preallocatedSize; // 0 if the file was not preallocated
+                bool mtimeDefined;
+                FILETIME mtime;
+                bool attribDefined;
+                uint32_t attrib;
+            };
+
+            WriteBehindQueue( uint32_t writers_count, size_t memory_budget );
+
+            ~WriteBehindQueue();
+
+            size_t chunkSize() const;
+
+            shared_ptr< File > addFile( COutFileStream* stream_spec, const wstring& path, uint64_t preallocated_size );
+
+            vector< byte_t > acquireBuffer();
+
+            HRESULT write( const shared_ptr< File >& file, vector< byte_t >& data );
+
+            HRESULT close( const shared_ptr< File >& file );
+
+            void finish();
+
+        private:
+            struct Task {
+                shared_ptr< File > file;
+                vector< byte_t > data;
+                bool close;
+            };
+
+            struct Writer {
+                deque< Task > tasks;
+                std::condition_variable tasksAvailable;
+                std::thread thread;
+            };
+
+            size_t mMemoryBudget;
+            size_t mChunkSize;
+            vector< unique_ptr< Writer > > mWriters;
+            size_t mNextWriter;
+
+            std::mutex mMutex;
+            std::condition_variable mTaskCompleted;
+            size_t mPendingBytes;
+            size_t mPendingTasks;
+            vector< vector< byte_t > > mFreeBuffers;
+            bool mStopping;
+            HRESULT mErrorCode;
+            wstring mErrorMessage;
+
+            HRESULT enqueue( const shared_ptr< File >& file, vector< byte_t >& data, bool close );
+
+            void run( Writer& writer );
+
+            void stop();
+    };
+}
+#endif // WRITEBEHINDQUEUE_HPP
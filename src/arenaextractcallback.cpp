@@ -0,0 +1,117 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+/*
+ * bit7z - A C++ static library to interface with the 7-zip DLLs.
+ * Copyright (c) 2014-2019  Riccardo Ostani - All Rights Reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * Bit7z is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with bit7z; if not, see https://www.gnu.org/licenses/.
+ */
+
+#include "../include/arenaextractcallback.hpp"
+
+#include "../include/cbufoutstream.hpp"
+#include "../include/bitpropvariant.hpp"
+#include "../include/bitexception.hpp"
+
+using namespace std;
+using namespace bit7z;
+
+ArenaExtractCallback::ArenaExtractCallback( const BitArchiveHandler& handler,
+                                            const BitInputArchive& inputArchive,
+                                            BitArenaMap& arenaMap )
+    : ExtractCallback( handler, inputArchive ),
+      mArenaMap( arenaMap ) {}
+
+ArenaExtractCallback::~ArenaExtractCallback() {}
+
+STDMETHODIMP ArenaExtractCallback::GetStream( UInt32 index, ISequentialOutStream** outStream, Int32 askExtractMode ) try {
+    *outStream = nullptr;
+    mOutMemStream.Release();
+
+    // Get Name
+    BitPropVariant prop = mInputArchive.getItemProperty( index, BitProperty::Path );
+    wstring fullPath;
+
+    if ( prop.isEmpty() ) {
+        fullPath = kEmptyFileAlias;
+    } else if ( prop.isString() ) {
+        fullPath = prop.getString();
+    } else {
+        return E_FAIL;
+    }
+
+    if ( askExtractMode != NArchive::NExtract::NAskMode::kExtract ) {
+        return S_OK;
+    }
+
+    if ( !mInputArchive.isItemFolder( index ) ) {
+        BitArenaMap::Entry entry;
+        entry.pathOffset = mArenaMap.mPaths.size();
+        entry.pathLength = fullPath.size();
+        entry.dataOffset = mArenaMap.mArena.size();
+        entry.dataSize = 0;
+        entry.index = index;
+        mArenaMap.mPaths.insert( mArenaMap.mPaths.end(), fullPath.cbegin(), fullPath.cend() );
+        mArenaMap.mEntries.push_back( entry );
+
+        // The content of the file is appended to the arena (the entry size is set once the file is complete)
+        auto* out_mem_stream_spec = new CBufOutStream( mArenaMap.mArena );
+        CMyComPtr< ISequentialOutStream > outStreamLoc( out_mem_stream_spec );
+        mOutMemStream = outStreamLoc;
+        *outStream = outStreamLoc.Detach();
+    }
+
+    return S_OK;
+} catch ( const BitException& ) {
+    return E_OUTOFMEMORY;
+} catch ( const std::bad_alloc& ) {
+    return E_OUTOFMEMORY;
+}
+
+STDMETHODIMP ArenaExtractCallback::SetOperationResult( Int32 operationResult ) {
+    switch ( operationResult ) {
+        case NArchive::NExtract::NOperationResult::kOK:
+            break;
+
+        default: {
+            mNumErrors++;
+
+            switch ( operationResult ) {
+                case NArchive::NExtract::NOperationResult::kUnsupportedMethod:
+                    mErrorMessage = kUnsupportedMethod;
+                    break;
+
+                case NArchive::NExtract::NOperationResult::kCRCError:
+                    mErrorMessage = kCRCFailed;
+                    break;
+
+                case NArchive::NExtract::NOperationResult::kDataError:
+                    mErrorMessage = kDataError;
+                    break;
+
+                default:
+                    mErrorMessage = kUnknownError;
+            }
+        }
+    }
+
+    if ( mOutMemStream ) {
+        BitArenaMap::Entry& entry = mArenaMap.mEntries.back();
+        entry.dataSize = mArenaMap.mArena.size() - entry.dataOffset;
+    }
+    mOutMemStream.Release();
+
+    return mNumErrors > 0 ? E_FAIL : S_OK;
+}
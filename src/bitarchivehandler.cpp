@@ -24,7 +24,8 @@
 using namespace bit7z;
 using std::wstring;
 
-BitArchiveHandler::BitArchiveHandler( const Bit7zLibrary& lib ) : mLibrary( lib ), mPassword( L"" ) {}
+BitArchiveHandler::BitArchiveHandler( const Bit7zLibrary& lib )
+    : mLibrary( lib ), mPassword( L"" ), mItemsCaching( false ), mMemoryMapping( false ), mSidecarIndex( false ) {}
 
 const Bit7zLibrary& BitArchiveHandler::library() const {
     return mLibrary;
@@ -40,6 +41,18 @@ bool BitArchiveHandler::isPasswordDefined() const {
     return !mPassword.empty();
 }
 
+bool BitArchiveHandler::itemsCaching() const {
+    return mItemsCaching;
+}
+
+bool BitArchiveHandler::memoryMapping() const {
+    return mMemoryMapping;
+}
+
+bool BitArchiveHandler::sidecarIndex() const {
+    return mSidecarIndex;
+}
+
 TotalCallback BitArchiveHandler::totalCallback() const {
     return mTotalCallback;
 }
@@ -68,6 +81,18 @@ void BitArchiveHandler::clearPassword() {
     setPassword( L"" );
 }
 
+void BitArchiveHandler::setItemsCaching( bool enable ) {
+    mItemsCaching = enable;
+}
+
+void BitArchiveHandler::setMemoryMapping( bool enable ) {
+    mMemoryMapping = enable;
+}
+
+void BitArchiveHandler::setSidecarIndex( bool enable ) {
+    mSidecarIndex = enable;
+}
+
 void BitArchiveHandler::setTotalCallback( const TotalCallback& callback ) {
     mTotalCallback = callback;
 }
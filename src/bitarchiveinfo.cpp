@@ -29,13 +29,20 @@
 using namespace bit7z;
 
 BitArchiveInfo::BitArchiveInfo( const Bit7zLibrary& lib, const wstring& in_file, const BitInFormat& format )
-    : BitArchiveOpener( lib, format ), BitInputArchive( *this, in_file ) {}
+    : BitArchiveOpener( lib, format ), BitInputArchive( *this, in_file ), mHasStatistics( false ), mStatistics() {}
 
 BitArchiveInfo::BitArchiveInfo( const Bit7zLibrary& lib, const vector< byte_t >& in_buffer, const BitInFormat& format )
-    : BitArchiveOpener( lib, format ), BitInputArchive( *this, in_buffer ) {}
+    : BitArchiveOpener( lib, format ), BitInputArchive( *this, in_buffer ), mHasStatistics( false ), mStatistics() {}
+
+BitArchiveInfo::BitArchiveInfo( const Bit7zLibrary& lib,
+                                const byte_t* in_buffer,
+                                size_t in_buffer_size,
+                                const BitInFormat& format )
+    : BitArchiveOpener( lib, format ), BitInputArchive( *this, in_buffer, in_buffer_size ),
+      mHasStatistics( false ), mStatistics() {}
 
 BitArchiveInfo::BitArchiveInfo( const Bit7zLibrary& lib, std::istream& in_stream, const BitInFormat& format )
-    : BitArchiveOpener( lib, format ), BitInputArchive( *this, in_stream ) {}
+    : BitArchiveOpener( lib, format ), BitInputArchive( *this, in_stream ), mHasStatistics( false ), mStatistics() {}
 
 BitArchiveInfo::~BitArchiveInfo() {}
 
@@ -54,7 +61,9 @@ map< BitProperty, BitPropVariant > BitArchiveInfo::archiveProperties() const {
 
 vector< BitArchiveItem > BitArchiveInfo::items() const {
     vector< BitArchiveItem > result;
-    for ( uint32_t i = 0; i < itemsCount(); ++i ) {
+    uint32_t items_count = itemsCount();
+    result.reserve( items_count );
+    for ( uint32_t i = 0; i < items_count; ++i ) {
         BitArchiveItem item( i );
         for ( uint32_t j = kpidNoProperty; j <= kpidCopyLink; ++j ) {
             // Yeah, I know, I double cast property (here and in getItemProperty), but the code is easier to read!
@@ -69,44 +78,95 @@ vector< BitArchiveItem > BitArchiveInfo::items() const {
     return result;
 }
 
-uint32_t BitArchiveInfo::foldersCount() const {
-    uint32_t result = 0;
-    for ( uint32_t i = 0; i < itemsCount(); ++i ) {
-        BitPropVariant prop = getItemProperty( i, BitProperty::IsDir );
-        if ( !prop.isEmpty() && prop.getBool() ) {
-            result += 1;
+vector< BitArchiveItem > BitArchiveInfo::items( const vector< BitProperty >& properties ) const {
+    vector< BitArchiveItem > result;
+    uint32_t items_count = itemsCount();
+    result.reserve( items_count );
+    for ( uint32_t i = 0; i < items_count; ++i ) {
+        BitArchiveItem item( i );
+        for ( BitProperty property : properties ) {
+            BitPropVariant property_value = getItemProperty( i, property );
+            if ( !property_value.isEmpty() ) {
+                item.setProperty( property, property_value );
+            }
         }
+        result.push_back( item );
     }
     return result;
 }
 
-uint32_t BitArchiveInfo::filesCount() const {
-    return itemsCount() - foldersCount(); //I'm lazy :)
-}
+const BitArchiveStatistics& BitArchiveInfo::statistics() const {
+    if ( mHasStatistics ) {
+        return mStatistics;
+    }
+
+    BitArchiveStatistics stats = BitArchiveStatistics();
+    uint32_t items_count = itemsCount();
+    for ( uint32_t i = 0; i < items_count; ++i ) {
+        if ( isItemFolder( i ) ) {
+            stats.foldersCount += 1;
+        } else {
+            stats.filesCount += 1;
+            /* Note: simple encryption (i.e. not including the archive headers) can be detected only reading
+             *       the properties of the files in the archive, so we count the encrypted files inside the archive! */
+            if ( isItemEncrypted( i ) ) {
+                stats.encryptedFilesCount += 1;
+            }
+        }
 
-uint64_t BitArchiveInfo::size() const {
-    uint64_t result = 0;
-    for ( uint32_t i = 0; i < itemsCount(); ++i ) {
         BitPropVariant prop = getItemProperty( i, BitProperty::Size );
         if ( !prop.isEmpty() ) {
-            result += prop.getUInt64();
+            uint64_t item_size = prop.getUInt64();
+            stats.size += item_size;
+            if ( item_size > stats.largestItemSize ) {
+                stats.largestItemSize = item_size;
+                stats.largestItemIndex = i;
+            }
         }
-    }
-    return result;
-}
 
-uint64_t BitArchiveInfo::packSize() const {
-    uint64_t result = 0;
-    for ( uint32_t i = 0; i < itemsCount(); ++i ) {
-        BitPropVariant prop = getItemProperty( i, BitProperty::PackSize );
+        prop = getItemProperty( i, BitProperty::PackSize );
         if ( !prop.isEmpty() ) {
-            result += prop.getUInt64();
+            stats.packSize += prop.getUInt64();
+        }
+
+        prop = getItemProperty( i, BitProperty::MTime );
+        if ( prop.isFiletime() ) {
+            FILETIME item_time = prop.getFiletime();
+            if ( !stats.hasModifiedTimes || CompareFileTime( &item_time, &stats.minModifiedTime ) < 0 ) {
+                stats.minModifiedTime = item_time;
+            }
+            if ( !stats.hasModifiedTimes || CompareFileTime( &item_time, &stats.maxModifiedTime ) > 0 ) {
+                stats.maxModifiedTime = item_time;
+            }
+            stats.hasModifiedTimes = true;
         }
     }
-    return result;
+
+    mStatistics = stats;
+    mHasStatistics = true;
+    return mStatistics;
+}
+
+uint32_t BitArchiveInfo::foldersCount() const {
+    return statistics().foldersCount;
+}
+
+uint32_t BitArchiveInfo::filesCount() const {
+    return statistics().filesCount;
+}
+
+uint64_t BitArchiveInfo::size() const {
+    return statistics().size;
+}
+
+uint64_t BitArchiveInfo::packSize() const {
+    return statistics().packSize;
 }
 
 bool BitArchiveInfo::hasEncryptedItems() const {
+    if ( mHasStatistics ) {
+        return mStatistics.encryptedFilesCount > 0;
+    }
     /* Note: simple encryption (i.e. not including the archive headers) can be detected only reading
      *       the properties of the files in the archive, so we search for any encrypted file inside the archive! */
     uint32_t items_count = itemsCount();
@@ -21,21 +21,39 @@
 
 #include "../include/bitarchiveopener.hpp"
 
+#include "../include/arenaextractcallback.hpp"
+#include "../include/bitarenamap.hpp"
 #include "../include/bitexception.hpp"
 #include "../include/bitinputarchive.hpp"
 #include "../include/fileextractcallback.hpp"
+#include "../include/indexedextractcallback.hpp"
 #include "../include/bufferextractcallback.hpp"
+#include "../include/cbufoutstream.hpp"
+#include "../include/deferredmetadata.hpp"
 #include "../include/streamextractcallback.hpp"
+#include "../include/visitorextractcallback.hpp"
+#include "../include/writebehindqueue.hpp"
 
+#include <algorithm>
+#include <exception>
 #include <map>
+#include <memory>
 
 using std::map;
+using std::unique_ptr;
 using namespace bit7z;
 
 CONSTEXPR auto kCannotExtractFolderToBuffer = "Cannot extract a folder to a buffer";
 
 BitArchiveOpener::BitArchiveOpener( const Bit7zLibrary& lib, const BitInFormat& format )
-    : BitArchiveHandler( lib ), mFormat( format ) {}
+    : BitArchiveHandler( lib ),
+      mFormat( format ),
+      mOverwriteMode( BitOverwriteMode::OVERWRITE ),
+      mCrcComparison( false ),
+      mWriteBehindThreads( 0 ),
+      mWriteBehindMemory( 0 ),
+      mPreallocationThreshold( 0 ),
+      mDeferredMetadata( false ) {}
 
 BitArchiveOpener::~BitArchiveOpener() {}
 
@@ -47,14 +65,108 @@ const BitInFormat& BitArchiveOpener::extractionFormat() const {
     return mFormat;
 }
 
+BitOverwriteMode BitArchiveOpener::overwriteMode() const {
+    return mOverwriteMode;
+}
+
+bool BitArchiveOpener::crcComparison() const {
+    return mCrcComparison;
+}
+
+uint32_t BitArchiveOpener::writeBehindThreads() const {
+    return mWriteBehindThreads;
+}
+
+size_t BitArchiveOpener::writeBehindMemory() const {
+    return mWriteBehindMemory;
+}
+
+uint64_t BitArchiveOpener::preallocationThreshold() const {
+    return mPreallocationThreshold;
+}
+
+bool BitArchiveOpener::deferredMetadata() const {
+    return mDeferredMetadata;
+}
+
+void BitArchiveOpener::setOverwriteMode( BitOverwriteMode mode ) {
+    mOverwriteMode = mode;
+}
+
+void BitArchiveOpener::setCrcComparison( bool enable ) {
+    mCrcComparison = enable;
+}
+
+void BitArchiveOpener::setWriteBehind( uint32_t writer_threads, size_t memory_budget ) {
+    mWriteBehindThreads = writer_threads;
+    mWriteBehindMemory = memory_budget;
+}
+
+void BitArchiveOpener::setPreallocationThreshold( uint64_t threshold ) {
+    mPreallocationThreshold = threshold;
+}
+
+void BitArchiveOpener::setDeferredMetadata( bool enable ) {
+    mDeferredMetadata = enable;
+}
+
 void BitArchiveOpener::extractToFileSystem( const BitInputArchive& in_archive,
                                             const wstring& in_file,
                                             const wstring& out_dir,
                                             const vector< uint32_t >& indices ) const {
-    CMyComPtr< ExtractCallback > extract_callback = new FileExtractCallback( *this, in_archive, in_file, out_dir );
+    runFileSystemExtraction( [ & ]( WriteBehindQueue* write_queue, DeferredMetadata* deferred_metadata ) {
+        extractToFileSystem( in_archive, in_file, out_dir, indices, write_queue, deferred_metadata );
+    });
+}
+
+void BitArchiveOpener::extractToFileSystem( const BitInputArchive& in_archive,
+                                            const wstring& in_file,
+                                            const wstring& out_dir,
+                                            const vector< uint32_t >& indices,
+                                            WriteBehindQueue* write_queue,
+                                            DeferredMetadata* deferred_metadata ) const {
+    CMyComPtr< ExtractCallback > extract_callback = new FileExtractCallback( *this,
+                                                                             in_archive,
+                                                                             in_file,
+                                                                             out_dir,
+                                                                             write_queue,
+                                                                             deferred_metadata );
     in_archive.extract( indices, extract_callback );
 }
 
+void BitArchiveOpener::runFileSystemExtraction(
+    const function< void( WriteBehindQueue*, DeferredMetadata* ) >& extraction ) const {
+    unique_ptr< WriteBehindQueue > write_queue;
+    if ( mWriteBehindThreads > 0 ) {
+        write_queue.reset( new WriteBehindQueue( mWriteBehindThreads, mWriteBehindMemory ) );
+    }
+    unique_ptr< DeferredMetadata > deferred_metadata;
+    if ( mDeferredMetadata ) {
+        deferred_metadata.reset( new DeferredMetadata() );
+    }
+
+    std::exception_ptr error;
+    try {
+        extraction( write_queue.get(), deferred_metadata.get() );
+    } catch ( ... ) {
+        error = std::current_exception();
+    }
+    if ( write_queue ) {
+        try { // waiting for all the files to be written and closed
+            write_queue->finish();
+        } catch ( const BitException& ) {
+            // If the extraction was aborted because of a failed write, this is the exception reporting its cause
+            error = std::current_exception();
+        }
+    }
+    if ( deferred_metadata ) { // the items extracted before an error (if any) get their metadata anyway
+        deferred_metadata->apply();
+    }
+    if ( error ) {
+        std::rethrow_exception( error );
+    }
+}
+
 void BitArchiveOpener::extractToStream( const BitInputArchive& in_archive,
                                         std::ostream& out_stream,
                                         unsigned int index ) const {
@@ -105,3 +217,78 @@ void BitArchiveOpener::extractToBufferMap( const BitInputArchive& in_archive,
     in_archive.extract( files_indices, extract_callback );
 
 }
+
+void BitArchiveOpener::extractToBuffers( const BitInputArchive& in_archive,
+                                         const vector< uint32_t >& indices,
+                                         vector< vector< byte_t > >& out_buffers ) const {
+    // Slots: for each requested item, the position of its buffer in out_buffers (sorted by item index)
+    uint32_t number_items = in_archive.itemsCount();
+    vector< IndexedExtractCallback::Slot > slots;
+    slots.reserve( indices.size() );
+    for ( size_t i = 0; i < indices.size(); ++i ) {
+        uint32_t index = indices[ i ];
+        if ( index >= number_items ) {
+            throw BitException( L"Index " + std::to_wstring( index ) + L" is not valid", E_INVALIDARG );
+        }
+        slots.push_back( IndexedExtractCallback::Slot( index, static_cast< uint32_t >( i ) ) );
+    }
+    std::sort( slots.begin(), slots.end() );
+
+    // 7-zip requires the indices of the items to be extracted to be in ascending order
+    vector< uint32_t > sorted_indices;
+    sorted_indices.reserve( slots.size() );
+    for ( const auto& slot : slots ) {
+        if ( !sorted_indices.empty() && sorted_indices.back() == slot.first ) {
+            throw BitException( L"Index " + std::to_wstring( slot.first ) + L" is repeated", E_INVALIDARG );
+        }
+        sorted_indices.push_back( slot.first );
+    }
+
+    out_buffers.clear();
+    out_buffers.resize( indices.size() );
+    CMyComPtr< ExtractCallback > extract_callback = new IndexedExtractCallback( *this,
+                                                                                in_archive,
+                                                                                slots,
+                                                                                out_buffers );
+    in_archive.extract( sorted_indices, extract_callback );
+}
+
+void BitArchiveOpener::extractToArenaMap( const BitInputArchive& in_archive, BitArenaMap& out_arena ) const {
+    uint32_t number_items = in_archive.itemsCount();
+    vector< uint32_t > files_indices;
+    uint64_t total_size = 0;
+    for ( uint32_t i = 0; i < number_items; ++i ) {
+        if ( !in_archive.isItemFolder( i ) ) { //Consider only files, not folders
+            files_indices.push_back( i );
+            total_size += in_archive.plausibleItemSize( i ); // implausible sizes are not trusted for the reservation
+        }
+    }
+
+    out_arena.clear();
+    out_arena.mEntries.reserve( files_indices.size() );
+    /* The contents of all the files are written using a single allocation, sized from their total unpacked size
+     * (if it cannot be allocated, the arena will grow as the contents are being written) */
+    CBufOutStream::reserveBuffer( out_arena.mArena, total_size );
+
+    CMyComPtr< ExtractCallback > extract_callback = new ArenaExtractCallback( *this, in_archive, out_arena );
+    try {
+        in_archive.extract( files_indices, extract_callback );
+    } catch ( ... ) { // the arena would be partially filled and not indexed
+        out_arena.clear();
+        throw;
+    }
+    out_arena.buildIndex();
+}
+
+void BitArchiveOpener::extractToVisitor( const BitInputArchive& in_archive,
+                                         const vector< uint32_t >& indices,
+                                         BitChunkVisitor& visitor ) const {
+    auto* extract_callback_spec = new VisitorExtractCallback( *this, in_archive, visitor );
+    CMyComPtr< ExtractCallback > extract_callback = extract_callback_spec;
+    try {
+        in_archive.extract( indices, extract_callback );
+    } catch ( const BitException& ) {
+        extract_callback_spec->rethrowVisitorException();
+        throw;
+    }
+}
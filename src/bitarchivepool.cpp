@@ -0,0 +1,113 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+/*
+ * bit7z - A C++ static library to interface with the 7-zip DLLs.
+ * Copyright (c) 2014-2019  Riccardo Ostani - All Rights Reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * Bit7z is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with bit7z; if not, see https://www.gnu.org/licenses/.
+ */
+
+#include "../include/bitarchivepool.hpp"
+
+#include <iterator>
+
+#include "../include/fsutil.hpp"
+
+using namespace bit7z;
+using namespace bit7z::filesystem;
+
+BitArchivePool::BitArchivePool( size_t max_idle_archives ) : mState( std::make_shared< State >() ) {
+    mState->maxIdleArchives = max_idle_archives;
+}
+
+BitArchivePool::~BitArchivePool() {}
+
+size_t BitArchivePool::maxIdleArchives() const {
+    return mState->maxIdleArchives;
+}
+
+size_t BitArchivePool::idleArchivesCount() const {
+    std::lock_guard< std::mutex > lock( mState->mutex );
+    return mState->idleArchives.size();
+}
+
+shared_ptr< BitInputArchive > BitArchivePool::acquire( const BitArchiveHandler& handler, const wstring& in_file ) {
+    if ( handler.isPasswordDefined() ) {
+        // Archives opened using a password are not pooled, so that they cannot be leased to other handlers
+        return std::make_shared< BitInputArchive >( handler, in_file );
+    }
+
+    IdleArchive leased;
+    leased.path = in_file;
+    leased.format = &handler.format();
+    if ( !fsutil::getFileStamp( in_file, leased.size, leased.lastWriteTime ) ) {
+        // The file cannot be stamped (e.g. it does not exist): not pooling it (opening it will report the error)
+        return std::make_shared< BitInputArchive >( handler, in_file );
+    }
+
+    {
+        std::lock_guard< std::mutex > lock( mState->mutex );
+        auto& idle_archives = mState->idleArchives;
+        for ( auto it = idle_archives.begin(); it != idle_archives.end(); ) {
+            if ( it->path != in_file ) {
+                ++it;
+            } else if ( it->size != leased.size || it->lastWriteTime != leased.lastWriteTime ) {
+                it = idle_archives.erase( it ); // the file was modified after being opened
+            } else if ( it->format == leased.format && !leased.archive ) {
+                leased.archive = it->archive;
+                it = idle_archives.erase( it );
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    if ( leased.archive ) {
+        leased.archive->setHandler( handler );
+    } else {
+        leased.archive = std::make_shared< BitInputArchive >( handler, in_file );
+        if ( leased.archive->mEncryptedHeaders ) { // the password was provided by the password callback
+            return leased.archive;
+        }
+    }
+
+    /* The lease is a pointer sharing the ownership of the archive, which returns the archive to the pool (if it still
+     * exists) when the last copy of the lease is destroyed */
+    std::weak_ptr< State > weak_state = mState;
+    BitInputArchive* archive = leased.archive.get();
+    return shared_ptr< BitInputArchive >( archive, [ weak_state, leased ]( BitInputArchive* ) mutable {
+        release( weak_state, leased );
+    } );
+}
+
+void BitArchivePool::clear() {
+    list< IdleArchive > closed_archives; // archives are closed outside the lock
+    std::lock_guard< std::mutex > lock( mState->mutex );
+    closed_archives.swap( mState->idleArchives );
+}
+
+void BitArchivePool::release( const std::weak_ptr< State >& weak_state, IdleArchive& idle_archive ) {
+    shared_ptr< State > state = weak_state.lock();
+    if ( !state || state->maxIdleArchives == 0 ) {
+        return; // the archive is closed when the lease deleter (holding the last reference to it) is destroyed
+    }
+
+    list< IdleArchive > closed_archives;
+    std::lock_guard< std::mutex > lock( state->mutex );
+    state->idleArchives.push_front( idle_archive );
+    while ( state->idleArchives.size() > state->maxIdleArchives ) {
+        closed_archives.splice( closed_archives.end(), state->idleArchives, std::prev( state->idleArchives.end() ) );
+    }
+}
@@ -0,0 +1,97 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+/*
+ * bit7z - A C++ static library to interface with the 7-zip DLLs.
+ * Copyright (c) 2014-2019  Riccardo Ostani - All Rights Reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * Bit7z is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with bit7z; if not, see https://www.gnu.org/licenses/.
+ */
+
+#include "../include/bitarenamap.hpp"
+
+#include <algorithm>
+#include <cwchar>
+
+using namespace bit7z;
+
+BitArenaMap::BitArenaMap() {}
+
+size_t BitArenaMap::size() const {
+    return mEntries.size();
+}
+
+bool BitArenaMap::empty() const {
+    return mEntries.empty();
+}
+
+wstring BitArenaMap::path( size_t pos ) const {
+    const Entry& entry = mEntries.at( pos );
+    return wstring( mPaths.data() + entry.pathOffset, entry.pathLength );
+}
+
+uint32_t BitArenaMap::index( size_t pos ) const {
+    return mEntries.at( pos ).index;
+}
+
+const byte_t* BitArenaMap::data( size_t pos ) const {
+    return mArena.data() + mEntries.at( pos ).dataOffset;
+}
+
+size_t BitArenaMap::dataSize( size_t pos ) const {
+    return mEntries.at( pos ).dataSize;
+}
+
+bool BitArenaMap::find( const wstring& path, size_t& pos ) const {
+    auto it = std::lower_bound( mSortedEntries.cbegin(), mSortedEntries.cend(), path,
+                                [ this ]( size_t entry_pos, const wstring& searched_path ) -> bool {
+                                    return comparePath( entry_pos, searched_path.c_str(), searched_path.size() ) < 0;
+                                } );
+    if ( it == mSortedEntries.cend() || comparePath( *it, path.c_str(), path.size() ) != 0 ) {
+        return false;
+    }
+    pos = *it;
+    return true;
+}
+
+const vector< byte_t >& BitArenaMap::arena() const {
+    return mArena;
+}
+
+void BitArenaMap::clear() {
+    mArena.clear();
+    mPaths.clear();
+    mEntries.clear();
+    mSortedEntries.clear();
+}
+
+int BitArenaMap::comparePath( size_t pos, const wchar_t* path, size_t path_length ) const {
+    const Entry& entry = mEntries[ pos ];
+    int result = std::wmemcmp( mPaths.data() + entry.pathOffset, path, std::min( entry.pathLength, path_length ) );
+    if ( result != 0 ) {
+        return result;
+    }
+    return entry.pathLength < path_length ? -1 : ( entry.pathLength > path_length ? 1 : 0 );
+}
+
+void BitArenaMap::buildIndex() {
+    mSortedEntries.resize( mEntries.size() );
+    for ( size_t i = 0; i < mEntries.size(); ++i ) {
+        mSortedEntries[ i ] = i;
+    }
+    std::stable_sort( mSortedEntries.begin(), mSortedEntries.end(), [ this ]( size_t first, size_t second ) -> bool {
+        const Entry& entry = mEntries[ second ];
+        return comparePath( first, mPaths.data() + entry.pathOffset, entry.pathLength ) < 0;
+    } );
+}
@@ -0,0 +1,146 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+/*
+ * bit7z - A C++ static library to interface with the 7-zip DLLs.
+ * Copyright (c) 2014-2019  Riccardo Ostani - All Rights Reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * Bit7z is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with bit7z; if not, see https://www.gnu.org/licenses/.
+ */
+
+#include "../include/bitblockcache.hpp"
+
+#include <algorithm>
+
+using namespace bit7z;
+
+bool BitBlockCache::ArchiveId::operator<( const ArchiveId& other ) const {
+    if ( path != other.path ) {
+        return path < other.path;
+    }
+    if ( size != other.size ) {
+        return size < other.size;
+    }
+    return lastWriteTime < other.lastWriteTime;
+}
+
+BitBlockCache::BitBlockCache( uint64_t budget ) : mBudget( budget ), mUsedSize( 0 ), mHits( 0 ), mMisses( 0 ) {}
+
+uint64_t BitBlockCache::budget() const {
+    return mBudget;
+}
+
+uint64_t BitBlockCache::usedSize() const {
+    std::lock_guard< std::mutex > lock( mMutex );
+    return mUsedSize;
+}
+
+size_t BitBlockCache::blocksCount() const {
+    std::lock_guard< std::mutex > lock( mMutex );
+    return mBlocks.size();
+}
+
+uint64_t BitBlockCache::hits() const {
+    std::lock_guard< std::mutex > lock( mMutex );
+    return mHits;
+}
+
+uint64_t BitBlockCache::misses() const {
+    std::lock_guard< std::mutex > lock( mMutex );
+    return mMisses;
+}
+
+void BitBlockCache::clear() {
+    std::lock_guard< std::mutex > lock( mMutex );
+    mBlocks.clear();
+    mArchives.clear();
+    mUsedSize = 0;
+}
+
+bool BitBlockCache::get( const ArchiveId& archive, uint32_t index, vector< byte_t >& out_buffer ) {
+    shared_ptr< Block > block;
+    const vector< byte_t >* item = nullptr;
+    {
+        std::lock_guard< std::mutex > lock( mMutex );
+        auto archive_it = mArchives.find( archive );
+        if ( archive_it != mArchives.end() ) {
+            const CachedArchive& cached_archive = archive_it->second;
+            auto item_it = cached_archive.itemsBlocks.find( index );
+            if ( item_it != cached_archive.itemsBlocks.end() ) {
+                BlockIterator block_it = cached_archive.blocks.find( item_it->second )->second;
+                block = *block_it;
+                item = findItem( *block, index );
+                mBlocks.splice( mBlocks.begin(), mBlocks, block_it ); // the block is now the most recently used
+            }
+        }
+        if ( !block ) {
+            ++mMisses;
+            return false;
+        }
+        ++mHits;
+    }
+
+    // Note: the block data is never modified once cached, so it can be copied without holding the lock
+    out_buffer = *item;
+    return true;
+}
+
+void BitBlockCache::put( const shared_ptr< Block >& block ) {
+    uint64_t block_size = block->size;
+    if ( block_size > mBudget ) {
+        return; // the block would evict all the others, and it would not fit in the cache anyway
+    }
+
+    std::lock_guard< std::mutex > lock( mMutex );
+    auto archive_it = mArchives.find( block->archive );
+    if ( archive_it != mArchives.end() &&
+         archive_it->second.blocks.find( block->id ) != archive_it->second.blocks.end() ) {
+        return; // the block was cached in the meantime (e.g. by another thread)
+    }
+
+    while ( !mBlocks.empty() && mUsedSize + block_size > mBudget ) {
+        evictLeastRecentlyUsed();
+    }
+    mBlocks.push_front( block );
+    mUsedSize += block_size;
+
+    CachedArchive& cached_archive = mArchives[ block->archive ];
+    cached_archive.blocks[ block->id ] = mBlocks.begin();
+    for ( uint32_t index : block->indices ) {
+        cached_archive.itemsBlocks[ index ] = block->id;
+    }
+}
+
+void BitBlockCache::evictLeastRecentlyUsed() {
+    const Block& block = *mBlocks.back();
+    auto archive_it = mArchives.find( block.archive );
+    CachedArchive& cached_archive = archive_it->second;
+    for ( uint32_t index : block.indices ) {
+        cached_archive.itemsBlocks.erase( index );
+    }
+    cached_archive.blocks.erase( block.id );
+    if ( cached_archive.blocks.empty() ) {
+        mArchives.erase( archive_it );
+    }
+    mUsedSize -= block.size;
+    mBlocks.pop_back();
+}
+
+const vector< byte_t >* BitBlockCache::findItem( const Block& block, uint32_t index ) {
+    auto it = std::lower_bound( block.indices.cbegin(), block.indices.cend(), index );
+    if ( it == block.indices.cend() || *it != index ) {
+        return nullptr;
+    }
+    return &block.buffers[ static_cast< size_t >( it - block.indices.cbegin() ) ];
+}
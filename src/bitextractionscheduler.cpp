@@ -0,0 +1,152 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+/*
+ * bit7z - A C++ static library to interface with the 7-zip DLLs.
+ * Copyright (c) 2014-2019  Riccardo Ostani - All Rights Reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * Bit7z is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with bit7z; if not, see https://www.gnu.org/licenses/.
+ */
+
+#include "../include/bitextractionscheduler.hpp"
+
+#include <algorithm>
+#include <map>
+
+#include "../include/bitexception.hpp"
+#include "../include/indexedextractcallback.hpp"
+
+using namespace bit7z;
+using std::map;
+
+CONSTEXPR uint64_t kNoBlock = static_cast< uint64_t >( -1 );
+
+BitExtractionScheduler::BitExtractionScheduler( const BitExtractor& extractor, const wstring& in_file )
+    : mExtractor( extractor ),
+      mInArchive( extractor, in_file ),
+      mItemsCount( mInArchive.itemsCount() ),
+      mStopping( false ) {
+    // Note: the worker must be started only once all the other members have been initialized
+    mWorker = std::thread( &BitExtractionScheduler::run, this );
+}
+
+BitExtractionScheduler::~BitExtractionScheduler() {
+    {
+        std::lock_guard< std::mutex > lock( mMutex );
+        mStopping = true;
+    }
+    mRequestsAvailable.notify_one();
+    if ( mWorker.joinable() ) {
+        mWorker.join();
+    }
+}
+
+uint32_t BitExtractionScheduler::itemsCount() const {
+    return mItemsCount;
+}
+
+std::future< vector< byte_t > > BitExtractionScheduler::request( uint32_t index ) {
+    if ( index >= mItemsCount ) {
+        throw BitException( L"Index " + std::to_wstring( index ) + L" is out of range", E_INVALIDARG );
+    }
+
+    std::future< vector< byte_t > > result;
+    {
+        std::lock_guard< std::mutex > lock( mMutex );
+        mPendingRequests.emplace_back( index );
+        result = mPendingRequests.back().result.get_future();
+    }
+    mRequestsAvailable.notify_one();
+    return result;
+}
+
+void BitExtractionScheduler::run() {
+    for ( ;; ) {
+        list< Request > requests;
+        {
+            std::unique_lock< std::mutex > lock( mMutex );
+            mRequestsAvailable.wait( lock, [ this ]() -> bool {
+                return !mPendingRequests.empty() || mStopping;
+            });
+            if ( mPendingRequests.empty() ) { // i.e. stopping, with all the requests satisfied
+                return;
+            }
+            // Taking all the requests collected so far, while new ones will be collected for the next pass
+            requests.splice( requests.end(), mPendingRequests );
+        }
+        process( requests );
+    }
+}
+
+void BitExtractionScheduler::process( list< Request >& requests ) {
+    // Grouping the requests by the solid block containing the requested item
+    map< uint64_t, vector< Request* > > blocks;
+    for ( Request& request : requests ) {
+        uint64_t block = kNoBlock;
+        try {
+            BitPropVariant prop = mInArchive.getItemProperty( request.index, BitProperty::Block );
+            if ( !prop.isEmpty() ) {
+                block = prop.getUInt64();
+            }
+        } catch ( const BitException& ) {} // the format does not report blocks: the item is decoded with the others
+        blocks[ block ].push_back( &request );
+    }
+
+    for ( auto& block : blocks ) {
+        vector< Request* >& block_requests = block.second;
+
+        // Each item is extracted once, even if requested multiple times
+        vector< uint32_t > indices;
+        indices.reserve( block_requests.size() );
+        for ( const Request* request : block_requests ) {
+            indices.push_back( request->index );
+        }
+        std::sort( indices.begin(), indices.end() );
+        indices.erase( std::unique( indices.begin(), indices.end() ), indices.end() );
+
+        vector< IndexedExtractCallback::Slot > slots;
+        slots.reserve( indices.size() );
+        for ( size_t i = 0; i < indices.size(); ++i ) {
+            slots.push_back( IndexedExtractCallback::Slot( indices[ i ], static_cast< uint32_t >( i ) ) );
+        }
+
+        vector< vector< byte_t > > buffers( indices.size() );
+        try {
+            CMyComPtr< ExtractCallback > extract_callback = new IndexedExtractCallback( mExtractor,
+                                                                                        mInArchive,
+                                                                                        slots,
+                                                                                        buffers );
+            mInArchive.extract( indices, extract_callback );
+        } catch ( ... ) {
+            for ( Request* request : block_requests ) {
+                request->result.set_exception( std::current_exception() );
+            }
+            continue;
+        }
+
+        // The last request of each item gets the extracted buffer, any previous one gets a copy of it
+        vector< size_t > requests_count( indices.size(), 0 );
+        for ( const Request* request : block_requests ) {
+            requests_count[ IndexedExtractCallback::findSlot( slots, request->index ) ] += 1;
+        }
+        for ( Request* request : block_requests ) {
+            uint32_t slot = IndexedExtractCallback::findSlot( slots, request->index );
+            if ( --requests_count[ slot ] == 0 ) {
+                request->result.set_value( std::move( buffers[ slot ] ) );
+            } else {
+                request->result.set_value( buffers[ slot ] );
+            }
+        }
+    }
+}
@@ -22,6 +22,9 @@
 #include "../include/bitextractor.hpp"
 
 #include <algorithm>
+#include <mutex>
+#include <numeric>
+#include <thread>
 #ifdef BIT7Z_REGEX_MATCHING
 #include <regex>
 #endif
@@ -30,6 +33,8 @@
 #include "../include/bitexception.hpp"
 #include "../include/fileextractcallback.hpp"
 #include "../include/fsutil.hpp"
+#include "../include/parallelfor.hpp"
+#include "../include/wildcardset.hpp"
 
 using namespace bit7z;
 using namespace bit7z::filesystem;
@@ -42,11 +47,138 @@ using std::wregex;
 
 CONSTEXPR auto kNoMatchingFile = "No matching file was found in the archive";
 
-BitExtractor::BitExtractor( const Bit7zLibrary& lib, const BitInFormat& format ) : BitArchiveOpener( lib, format ) {}
+/* Progress of a parallel extraction: each worker reports its own values, while the callbacks of the user receive the
+ * sums over all the workers (the total size grows as the workers start their work). User callbacks are serialized. */
+class ParallelProgress {
+    public:
+        ParallelProgress( const BitArchiveHandler& handler, size_t workers_count )
+            : mHandler( handler ), mTotals( workers_count, 0 ), mCompleted( workers_count, 0 ),
+              mInSizes( workers_count, 0 ), mOutSizes( workers_count, 0 ) {}
+
+        void setTotal( size_t worker, uint64_t total_size ) {
+            std::lock_guard< std::mutex > lock( mMutex );
+            if ( mHandler.totalCallback() ) {
+                mTotals[ worker ] = total_size;
+                mHandler.totalCallback()( sum( mTotals ) );
+            }
+        }
+
+        void setCompleted( size_t worker, uint64_t progress_size ) {
+            std::lock_guard< std::mutex > lock( mMutex );
+            if ( mHandler.progressCallback() ) {
+                mCompleted[ worker ] = progress_size;
+                mHandler.progressCallback()( sum( mCompleted ) );
+            }
+        }
+
+        void setRatio( size_t worker, uint64_t input_size, uint64_t output_size ) {
+            std::lock_guard< std::mutex > lock( mMutex );
+            if ( mHandler.ratioCallback() ) {
+                mInSizes[ worker ] = input_size;
+                mOutSizes[ worker ] = output_size;
+                mHandler.ratioCallback()( sum( mInSizes ), sum( mOutSizes ) );
+            }
+        }
+
+        void setFile( const wstring& filename ) {
+            std::lock_guard< std::mutex > lock( mMutex );
+            if ( mHandler.fileCallback() ) {
+                mHandler.fileCallback()( filename );
+            }
+        }
+
+        wstring password() {
+            std::lock_guard< std::mutex > lock( mMutex );
+            if ( mPassword.empty() && mHandler.passwordCallback() ) {
+                mPassword = mHandler.passwordCallback()(); // asked only once, the answer is shared by all the workers
+            }
+            return mPassword;
+        }
+
+    private:
+        const BitArchiveHandler& mHandler;
+        std::mutex mMutex;
+        vector< uint64_t > mTotals;
+        vector< uint64_t > mCompleted;
+        vector< uint64_t > mInSizes;
+        vector< uint64_t > mOutSizes;
+        wstring mPassword;
+
+        static uint64_t sum( const vector< uint64_t >& values ) {
+            return std::accumulate( values.cbegin(), values.cend(), static_cast< uint64_t >( 0 ) );
+        }
+};
+
+bool isSolidArchive( const BitInputArchive& in_archive ) {
+    BitPropVariant propvar = in_archive.getArchiveProperty( BitProperty::Solid );
+    return propvar.isBool() && propvar.getBool();
+}
+
+/* Splits the given items into at most chunks_count contiguous chunks having (roughly) the same uncompressed size */
+vector< vector< uint32_t > > splitItems( const BitInputArchive& in_archive,
+                                         const vector< uint32_t >& indices,
+                                         size_t chunks_count ) {
+    vector< uint64_t > sizes;
+    sizes.reserve( indices.size() );
+    uint64_t total_size = 0;
+    for ( uint32_t index : indices ) {
+        BitPropVariant prop = in_archive.getItemProperty( index, BitProperty::Size );
+        uint64_t size = prop.isEmpty() ? 0 : prop.getUInt64();
+        sizes.push_back( size + 1 ); // + 1 so that also empty items (e.g. folders) are distributed among the chunks
+        total_size += size + 1;
+    }
+
+    vector< vector< uint32_t > > chunks( 1 );
+    uint64_t chunk_size = 0;
+    for ( size_t i = 0; i < indices.size(); ++i ) {
+        chunks.back().push_back( indices[ i ] );
+        chunk_size += sizes[ i ];
+        if ( chunks.size() < chunks_count && chunk_size >= total_size / chunks_count && i + 1 < indices.size() ) {
+            chunks.emplace_back();
+            chunk_size = 0;
+        }
+    }
+    return chunks;
+}
+
+BitExtractor::BitExtractor( const Bit7zLibrary& lib, const BitInFormat& format )
+    : BitArchiveOpener( lib, format ), mThreadsCount( 1 ) {}
+
+uint32_t BitExtractor::threadsCount() const {
+    return mThreadsCount;
+}
+
+void BitExtractor::setThreadsCount( uint32_t threads_count ) {
+    mThreadsCount = threads_count;
+}
+
+shared_ptr< BitBlockCache > BitExtractor::blockCache() const {
+    return mBlockCache;
+}
+
+void BitExtractor::setBlockCache( const shared_ptr< BitBlockCache >& cache ) {
+    mBlockCache = cache;
+}
+
+shared_ptr< BitArchivePool > BitExtractor::archivePool() const {
+    return mArchivePool;
+}
+
+void BitExtractor::setArchivePool( const shared_ptr< BitArchivePool >& pool ) {
+    mArchivePool = pool;
+}
+
+shared_ptr< BitInputArchive > BitExtractor::openArchive( const wstring& in_file ) const {
+    if ( mArchivePool ) {
+        return mArchivePool->acquire( *this, in_file );
+    }
+    return std::make_shared< BitInputArchive >( *this, in_file );
+}
 
 void BitExtractor::extract( const wstring& in_file, const wstring& out_dir ) const {
-    BitInputArchive in_archive( *this, in_file );
-    extractToFileSystem( in_archive, in_file, out_dir, vector< uint32_t >() );
+    const auto archive_lease = openArchive( in_file );
+    const BitInputArchive& in_archive = *archive_lease;
+    extractToDirectory( in_archive, in_file, out_dir, vector< uint32_t >() );
 }
 
 void BitExtractor::extractMatching( const wstring& in_file, const wstring& item_filter, const wstring& out_dir ) const {
@@ -54,8 +186,25 @@ void BitExtractor::extractMatching( const wstring& in_file, const wstring& item_
         throw BitException( "Empty wildcard filter", E_INVALIDARG );
     }
 
-    extractMatchingFilter( in_file, out_dir, [ &item_filter ]( const wstring& item_path ) -> bool {
-        return fsutil::wildcardMatch( item_filter, item_path );
+    const WildcardPattern filter_pattern( item_filter );
+    extractMatchingFilter( in_file, out_dir, [ &filter_pattern ]( const wstring& item_path ) -> bool {
+        return filter_pattern.matches( item_path );
+    });
+}
+
+void BitExtractor::extractMatching( const wstring& in_file,
+                                    const vector< wstring >& include_filters,
+                                    const vector< wstring >& exclude_filters,
+                                    const wstring& out_dir,
+                                    bool case_sensitive ) const {
+    if ( include_filters.empty() && exclude_filters.empty() ) {
+        throw BitException( "Empty wildcard filters", E_INVALIDARG );
+    }
+
+    const WildcardSet include_set( include_filters, case_sensitive );
+    const WildcardSet exclude_set( exclude_filters, case_sensitive );
+    extractMatchingFilter( in_file, out_dir, [ &include_set, &exclude_set ]( const wstring& item_path ) -> bool {
+        return ( include_set.empty() || include_set.matches( item_path ) ) && !exclude_set.matches( item_path );
     });
 }
 
@@ -72,10 +221,129 @@ void BitExtractor::extractMatchingRegex( const wstring& in_file, const wstring&
 }
 #endif
 
+void BitExtractor::extractToDirectory( const BitInputArchive& in_archive,
+                                       const wstring& in_file,
+                                       const wstring& out_dir,
+                                       const vector< uint32_t >& indices ) const {
+    uint32_t threads_count = mThreadsCount != 0 ? mThreadsCount : std::max( std::thread::hardware_concurrency(), 1u );
+    if ( threads_count == 1 || isSolidArchive( in_archive ) ) {
+        extractToFileSystem( in_archive, in_file, out_dir, indices );
+        return;
+    }
+
+    vector< uint32_t > items = indices;
+    if ( items.empty() ) {
+        items.resize( in_archive.itemsCount() );
+        std::iota( items.begin(), items.end(), 0 );
+    }
+    const vector< vector< uint32_t > > chunks = splitItems( in_archive, items, threads_count );
+    if ( chunks.size() == 1 ) {
+        extractToFileSystem( in_archive, in_file, out_dir, indices );
+        return;
+    }
+
+    ParallelProgress progress( *this, chunks.size() );
+    /* The write-behind queue and the deferred metadata (if enabled) are shared by all the workers: the memory budget
+     * and the writer threads are the ones of the whole extraction, and the metadata of the folders is applied only
+     * once all the workers have completed */
+    runFileSystemExtraction( [ & ]( WriteBehindQueue* write_queue, DeferredMetadata* deferred_metadata ) {
+        parallelFor( chunks.size(), threads_count, [ & ]( size_t worker ) {
+            /* Each worker uses a copy of this extractor whose callbacks forward to the shared progress object
+             * (the password, if any, is copied too) */
+            BitExtractor worker_extractor( *this );
+            worker_extractor.setTotalCallback( [ &progress, worker ]( uint64_t total_size ) {
+                progress.setTotal( worker, total_size );
+            });
+            worker_extractor.setProgressCallback( [ &progress, worker ]( uint64_t progress_size ) {
+                progress.setCompleted( worker, progress_size );
+            });
+            worker_extractor.setRatioCallback( [ &progress, worker ]( uint64_t input_size, uint64_t output_size ) {
+                progress.setRatio( worker, input_size, output_size );
+            });
+            worker_extractor.setFileCallback( [ &progress ]( wstring filename ) {
+                progress.setFile( filename );
+            });
+            worker_extractor.setPasswordCallback( [ &progress ]() -> wstring {
+                return progress.password();
+            });
+
+            if ( worker == 0 ) { // the first chunk is extracted using the archive handle already opened
+                worker_extractor.extractToFileSystem( in_archive,
+                                                      in_file,
+                                                      out_dir,
+                                                      chunks[ worker ],
+                                                      write_queue,
+                                                      deferred_metadata );
+            } else {
+                const auto worker_archive = worker_extractor.openArchive( in_file );
+                worker_extractor.extractToFileSystem( *worker_archive,
+                                                      in_file,
+                                                      out_dir,
+                                                      chunks[ worker ],
+                                                      write_queue,
+                                                      deferred_metadata );
+            }
+        });
+    });
+}
+
+void BitExtractor::extractBlockToCache( const BitInputArchive& in_archive,
+                                        const BitBlockCache::ArchiveId& archive_id,
+                                        vector< byte_t >& out_buffer,
+                                        unsigned int index ) const {
+    uint32_t number_items = in_archive.itemsCount();
+    BitPropVariant block_prop;
+    if ( index < number_items && !in_archive.isItemFolder( index ) ) {
+        block_prop = in_archive.getItemProperty( index, BitProperty::Block );
+    }
+    // Not a valid file, or not in a solid block, or in an encrypted archive: nothing to be cached
+    if ( block_prop.isEmpty() || in_archive.mEncryptedHeaders ) {
+        extractToBuffer( in_archive, out_buffer, index );
+        return;
+    }
+
+    // Decoding all the files in the same solid block of the requested one
+    uint64_t block_id = block_prop.getUInt64();
+    vector< uint32_t > block_indices;
+    for ( uint32_t i = 0; i < number_items; ++i ) {
+        if ( !in_archive.isItemFolder( i ) ) {
+            BitPropVariant prop = in_archive.getItemProperty( i, BitProperty::Block );
+            if ( !prop.isEmpty() && prop.getUInt64() == block_id ) {
+                if ( in_archive.isItemEncrypted( i ) ) { // the decoded data must not be available without a password
+                    extractToBuffer( in_archive, out_buffer, index );
+                    return;
+                }
+                block_indices.push_back( i );
+            }
+        }
+    }
+    auto block = std::make_shared< BitBlockCache::Block >();
+    block->archive = archive_id;
+    block->id = block_id;
+    block->size = 0;
+    extractToBuffers( in_archive, block_indices, block->buffers );
+    for ( const auto& buffer : block->buffers ) {
+        block->size += buffer.size();
+    }
+
+    // The decoded buffers are moved in the block (block_indices is in ascending order, as required by the cache)
+    const size_t position = static_cast< size_t >( std::lower_bound( block_indices.begin(),
+                                                                     block_indices.end(),
+                                                                     index ) - block_indices.begin() );
+    if ( block->size > mBlockCache->budget() ) { // the block cannot be cached, no need to copy the item
+        out_buffer = std::move( block->buffers[ position ] );
+        return;
+    }
+    out_buffer = block->buffers[ position ];
+    block->indices = std::move( block_indices );
+    mBlockCache->put( block );
+}
+
 void BitExtractor::extractMatchingFilter( const wstring& in_file,
                                           const wstring& out_dir,
                                           const function< bool( const wstring& ) >& filter ) const {
-    BitInputArchive in_archive( *this, in_file );
+    const auto archive_lease = openArchive( in_file );
+    const BitInputArchive& in_archive = *archive_lease;
 
     vector< uint32_t > matched_indices;
     //Searching for files inside the archive that match the given regex filter
@@ -91,7 +359,7 @@ void BitExtractor::extractMatchingFilter( const wstring& in_file,
         throw BitException( kNoMatchingFile, ERROR_FILE_NOT_FOUND );
     }
 
-    extractToFileSystem( in_archive, in_file, out_dir, matched_indices );
+    extractToDirectory( in_archive, in_file, out_dir, matched_indices );
 }
 
 void BitExtractor::extractItems( const wstring& in_file,
@@ -101,7 +369,8 @@ void BitExtractor::extractItems( const wstring& in_file,
         throw BitException( "Empty indices vector", E_INVALIDARG );
     }
 
-    BitInputArchive in_archive( *this, in_file );
+    const auto archive_lease = openArchive( in_file );
+    const BitInputArchive& in_archive = *archive_lease;
     uint32_t n_items = in_archive.itemsCount();
     const auto find_res = std::find_if( indices.cbegin(), indices.cend(), [ &n_items ]( uint32_t index ) -> bool {
         return index >= n_items;
@@ -110,26 +379,143 @@ void BitExtractor::extractItems( const wstring& in_file,
         throw BitException( L"Index " + std::to_wstring( *find_res ) + L" is not valid", E_INVALIDARG );
     }
 
-    extractToFileSystem( in_archive, in_file, out_dir, indices );
+    extractToDirectory( in_archive, in_file, out_dir, indices );
+}
+
+void BitExtractor::extractPaths( const wstring& in_file,
+                                 const vector< wstring >& item_paths,
+                                 const wstring& out_dir,
+                                 bool case_sensitive ) const {
+    if ( item_paths.empty() ) {
+        throw BitException( "Empty paths vector", E_INVALIDARG );
+    }
+
+    const auto archive_lease = openArchive( in_file );
+    const BitInputArchive& in_archive = *archive_lease;
+    vector< uint32_t > indices;
+    indices.reserve( item_paths.size() );
+    for ( const auto& item_path : item_paths ) {
+        uint32_t index = 0;
+        if ( !in_archive.findItem( item_path, index, case_sensitive ) ) {
+            throw BitException( L"Cannot find item '" + item_path + L"' in the archive", ERROR_FILE_NOT_FOUND );
+        }
+        indices.push_back( index );
+    }
+    std::sort( indices.begin(), indices.end() );
+    indices.erase( std::unique( indices.begin(), indices.end() ), indices.end() );
+
+    extractToDirectory( in_archive, in_file, out_dir, indices );
 }
 
 void BitExtractor::extract( const wstring& in_file, vector< byte_t >& out_buffer, unsigned int index ) const {
-    BitInputArchive in_archive( *this, in_file );
-    extractToBuffer( in_archive, out_buffer, index );
+    BitBlockCache::ArchiveId archive_id;
+    archive_id.path = in_file;
+    // Note: the cache may be shared with extractors having no password, so encrypted data is never cached
+    if ( !mBlockCache || isPasswordDefined() ||
+         !fsutil::getFileStamp( in_file, archive_id.size, archive_id.lastWriteTime ) ) {
+        const auto archive_lease = openArchive( in_file );
+        const BitInputArchive& in_archive = *archive_lease;
+        extractToBuffer( in_archive, out_buffer, index );
+        return;
+    }
+
+    if ( mBlockCache->get( archive_id, index, out_buffer ) ) {
+        return;
+    }
+    const auto archive_lease = openArchive( in_file );
+    const BitInputArchive& in_archive = *archive_lease;
+    extractBlockToCache( in_archive, archive_id, out_buffer, index );
 }
 
 void BitExtractor::extract( const std::wstring& in_file, std::ostream& out_stream, unsigned int index ) const {
-    BitInputArchive in_archive( *this, in_file );
+    const auto archive_lease = openArchive( in_file );
+    const BitInputArchive& in_archive = *archive_lease;
     extractToStream( in_archive, out_stream, index );
 }
 
 void BitExtractor::extract( const wstring& in_file, map< wstring, vector< byte_t > >& out_map ) const {
-    BitInputArchive in_archive( *this, in_file );
+    const auto archive_lease = openArchive( in_file );
+    const BitInputArchive& in_archive = *archive_lease;
     extractToBufferMap( in_archive, out_map );
 }
 
+void BitExtractor::extractItems( const wstring& in_file,
+                                 const vector< uint32_t >& indices,
+                                 vector< vector< byte_t > >& out_buffers ) const {
+    if ( indices.empty() ) {
+        throw BitException( "Empty indices vector", E_INVALIDARG );
+    }
+
+    const auto archive_lease = openArchive( in_file );
+    const BitInputArchive& in_archive = *archive_lease;
+    extractToBuffers( in_archive, indices, out_buffers );
+}
+
+void BitExtractor::extract( const wstring& in_file, BitChunkVisitor& visitor ) const {
+    const auto archive_lease = openArchive( in_file );
+    const BitInputArchive& in_archive = *archive_lease;
+    extractToVisitor( in_archive, vector< uint32_t >(), visitor );
+}
+
+void BitExtractor::extractItems( const wstring& in_file,
+                                 const vector< uint32_t >& indices,
+                                 BitChunkVisitor& visitor ) const {
+    if ( indices.empty() ) {
+        throw BitException( "Empty indices vector", E_INVALIDARG );
+    }
+
+    const auto archive_lease = openArchive( in_file );
+    const BitInputArchive& in_archive = *archive_lease;
+    uint32_t n_items = in_archive.itemsCount();
+    const auto find_res = std::find_if( indices.cbegin(), indices.cend(), [ &n_items ]( uint32_t index ) -> bool {
+        return index >= n_items;
+    });
+    if ( find_res != indices.cend() ) {
+        throw BitException( L"Index " + std::to_wstring( *find_res ) + L" is not valid", E_INVALIDARG );
+    }
+
+    // The archive requires the indices in ascending order (the visitor is told the index of each item anyway)
+    vector< uint32_t > sorted_indices( indices );
+    std::sort( sorted_indices.begin(), sorted_indices.end() );
+    const auto repeated = std::adjacent_find( sorted_indices.cbegin(), sorted_indices.cend() );
+    if ( repeated != sorted_indices.cend() ) {
+        throw BitException( L"Index " + std::to_wstring( *repeated ) + L" is repeated", E_INVALIDARG );
+    }
+
+    extractToVisitor( in_archive, sorted_indices, visitor );
+}
+
+void BitExtractor::extract( const wstring& in_file, BitArenaMap& out_arena ) const {
+    const auto archive_lease = openArchive( in_file );
+    const BitInputArchive& in_archive = *archive_lease;
+    extractToArenaMap( in_archive, out_arena );
+}
+
+vector< BitBatchResult > BitExtractor::extract( const vector< BitBatchJob >& jobs ) const {
+    vector< BitBatchResult > results( jobs.size() );
+    parallelFor( jobs.size(), mThreadsCount, [ this, &jobs, &results ]( size_t i ) {
+        const BitBatchJob& job = jobs[ i ];
+        BitBatchResult& result = results[ i ];
+        result.inFile = job.inFile;
+        result.errorCode = S_OK;
+        try {
+            const auto archive_lease = openArchive( job.inFile );
+            const BitInputArchive& in_archive = *archive_lease;
+            extractToFileSystem( in_archive, job.inFile, job.outDir, vector< uint32_t >() );
+        } catch ( BitException& ex ) {
+            result.errorCode = ex.getErrorCode();
+            result.errorMessage = ex.what();
+        } catch ( const std::exception& ex ) {
+            result.errorCode = E_FAIL;
+            result.errorMessage = ex.what();
+        }
+    });
+    return results;
+}
+
 void BitExtractor::test( const wstring& in_file ) const {
-    BitInputArchive in_archive( *this, in_file );
+    const auto archive_lease = openArchive( in_file );
+    const BitInputArchive& in_archive = *archive_lease;
 
     CMyComPtr< ExtractCallback > extract_callback = new FileExtractCallback( *this, in_archive, in_file, L"" );
     in_archive.test( extract_callback );
@@ -512,6 +512,21 @@ namespace bit7z {
             // The extension did not match any known format extension, delegating the decision to the client
             return Auto;
         }
+
+        const BitInFormat& findFormatByValue( int value ) {
+            static const BitInFormat* const formats[] = {
+                &Zip, &BZip2, &Rar, &Arj, &Z, &Lzh, &SevenZip, &Cab, &Nsis, &Lzma, &Lzma86, &Xz, &Ppmd, &COFF, &Ext,
+                &VMDK, &VDI, &QCow, &GPT, &Rar5, &IHex, &Hxs, &TE, &UEFIc, &UEFIs, &SquashFS, &CramFS, &APM, &Mslz,
+                &Flv, &Swf, &Swfc, &Ntfs, &Fat, &Mbr, &Vhd, &Pe, &Elf, &Macho, &Udf, &Xar, &Mub, &Hfs, &Dmg,
+                &Compound, &Wim, &Iso, &Chm, &Split, &Rpm, &Deb, &Cpio, &Tar, &GZip
+            };
+            for ( const BitInFormat* format : formats ) {
+                if ( format->value() == value ) {
+                    return *format;
+                }
+            }
+            return Auto;
+        }
 #endif
 
     }
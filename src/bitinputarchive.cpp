@@ -21,10 +21,16 @@
 
 #include "../include/bitinputarchive.hpp"
 
+#include <algorithm>
+
 #include "../include/bitexception.hpp"
+#include "../include/cfilemappinginstream.hpp"
 #include "../include/cstdinstream.hpp"
 #include "../include/opencallback.hpp"
 #include "../include/extractcallback.hpp"
+#include "../include/itemscache.hpp"
+#include "../include/itemspathindex.hpp"
+#include "../include/visitorextractcallback.hpp"
 
 #include "Common/MyCom.h"
 #include "7zip/Common/FileStreams.h"
@@ -39,10 +45,106 @@ namespace bit7z {
     namespace BitFormat {
         const BitInFormat& detectFormatFromExt( const wstring& in_file );
         const BitInFormat& detectFormatFromSig( IInStream* stream );
+        const BitInFormat& findFormatByValue( int value );
     }
 }
 #endif
 
+/* Visitor collecting the bytes of an item in a given range: once the range is complete, it stops the extraction
+ * (so that the rest of the item is not decoded) */
+class RangeVisitor : public BitChunkVisitor {
+    public:
+        RangeVisitor( uint64_t offset, size_t length, vector< byte_t >& out_buffer )
+            : mOffset( offset ), mLength( length ), mPosition( 0 ), mOutBuffer( out_buffer ) {}
+
+        bool onChunk( uint32_t /*index*/, const byte_t* data, size_t size ) override {
+            uint64_t chunk_end = mPosition + size;
+            if ( chunk_end > mOffset ) {
+                size_t skip = mPosition < mOffset ? static_cast< size_t >( mOffset - mPosition ) : 0;
+                size_t copy_size = std::min( size - skip, mLength - mOutBuffer.size() );
+                mOutBuffer.insert( mOutBuffer.end(), data + skip, data + skip + copy_size );
+            }
+            mPosition = chunk_end;
+            return !isComplete();
+        }
+
+        bool isComplete() const {
+            return mOutBuffer.size() == mLength;
+        }
+
+    private:
+        uint64_t mOffset;
+        size_t mLength;
+        uint64_t mPosition;
+        vector< byte_t >& mOutBuffer;
+};
+
+CONSTEXPR size_t kMinRangeBufferSize = 64 * 1024;
+
+// Maximum ratio between the declared size of an item and its packed size for the former to be considered plausible
+CONSTEXPR auto kMaxCompressionRatio = 256u;
+
+void readStreamRange( ISequentialInStream* in_stream, uint64_t offset, size_t length, vector< byte_t >& out_buffer ) {
+    CMyComPtr< IInStream > seekable_stream;
+    bool exact_length = false; // true if length is known not to exceed the end of the item
+    if ( in_stream->QueryInterface( ::IID_IInStream, reinterpret_cast< void** >( &seekable_stream ) ) == S_OK &&
+         seekable_stream ) {
+        UInt64 stream_size = 0;
+        HRESULT res = seekable_stream->Seek( 0, STREAM_SEEK_END, &stream_size );
+        if ( res == S_OK ) {
+            if ( offset >= stream_size ) {
+                return; // the item is shorter than the offset
+            }
+            length = static_cast< size_t >( std::min< uint64_t >( length, stream_size - offset ) );
+            exact_length = true;
+        }
+        res = seekable_stream->Seek( static_cast< Int64 >( offset ), STREAM_SEEK_SET, nullptr );
+        if ( res != S_OK ) {
+            throw BitException( "Could not seek the item stream", res );
+        }
+    } else { // the stream is not seekable: skipping the bytes before the range
+        vector< byte_t > skip_buffer( static_cast< size_t >( std::min< uint64_t >( offset, 64 * 1024 ) ) );
+        while ( offset > 0 ) {
+            UInt32 processed_size = 0;
+            UInt32 skip_size = static_cast< UInt32 >( std::min< uint64_t >( offset, skip_buffer.size() ) );
+            HRESULT res = in_stream->Read( skip_buffer.data(), skip_size, &processed_size );
+            if ( res != S_OK ) {
+                throw BitException( "Could not read the item stream", res );
+            }
+            if ( processed_size == 0 ) {
+                return; // the item is shorter than the offset
+            }
+            offset -= processed_size;
+        }
+    }
+
+    /* If the length of the range could exceed the end of the item, the buffer grows geometrically while reading
+     * (so that asking for "up to length bytes" does not allocate length bytes upfront) */
+    out_buffer.resize( exact_length ? length : std::min( length, kMinRangeBufferSize ) );
+    size_t total_size = 0;
+    while ( total_size < length ) {
+        if ( total_size == out_buffer.size() ) {
+            out_buffer.resize( total_size + std::min( length - total_size, total_size ) );
+        }
+        UInt32 processed_size = 0;
+        UInt32 read_size = static_cast< UInt32 >( std::min< size_t >( out_buffer.size() - total_size, UINT32_MAX ) );
+        HRESULT res = in_stream->Read( out_buffer.data() + total_size, read_size, &processed_size );
+        if ( res != S_OK ) {
+            out_buffer.clear();
+            throw BitException( "Could not read the item stream", res );
+        }
+        if ( processed_size == 0 ) {
+            break; // end of the item
+        }
+        total_size += processed_size;
+    }
+    out_buffer.resize( total_size );
+}
+
+wstring sidecarIndexPath( const wstring& in_file ) {
+    return in_file + L".bit7zidx";
+}
+
 CMyComPtr< IInArchive > initArchiveObject( const Bit7zLibrary& lib, const GUID* format_GUID ) {
     CMyComPtr< IInArchive > arc_object;
     lib.createArchiveObject( format_GUID, &::IID_IInArchive, reinterpret_cast< void** >( &arc_object ) );
@@ -51,7 +153,7 @@ CMyComPtr< IInArchive > initArchiveObject( const Bit7zLibrary& lib, const GUID*
 
 IInArchive* BitInputArchive::openArchiveStream( const BitArchiveHandler& handler,
                                                 const wstring& name,
-                                                IInStream* in_stream ) {
+                                                IInStream* in_stream ) const {
 #ifdef BIT7Z_AUTO_FORMAT
     bool detected_by_signature = false;
     if ( *mDetectedFormat == BitFormat::Auto ) {
@@ -93,14 +195,18 @@ IInArchive* BitInputArchive::openArchiveStream( const BitArchiveHandler& handler
         throw BitException( L"Cannot open archive '" + name + L"'", ERROR_OPEN_FAILED );
     }
 
+    mEncryptedHeaders = open_callback_spec->passwordRequested();
     return in_archive.Detach();
 }
 
-BitInputArchive::BitInputArchive( const BitArchiveHandler& handler, const wstring& in_file ) {
-    auto* file_stream_spec = new CInFileStream;
-    CMyComPtr< IInStream > file_stream = file_stream_spec;
-    if ( !file_stream_spec->Open( in_file.c_str() ) ) {
-        throw BitException( L"Cannot open archive file '" + in_file + L"'", ERROR_OPEN_FAILED );
+BitInputArchive::BitInputArchive( const BitArchiveHandler& handler, const wstring& in_file )
+    : mHandler( &handler ),
+      mInArchive( nullptr ),
+      mDetectedFormat( nullptr ),
+      mEncryptedHeaders( false ),
+      mArchivePath( in_file ) {
+    if ( useSidecarIndex( handler ) && loadSidecarIndex( handler ) ) {
+        return; // the archive file will be opened only when needed (see inArchive())
     }
 #ifdef BIT7Z_AUTO_FORMAT
     //if auto, detect format from signature here (and try later from content if this fails), otherwise try passed format
@@ -109,27 +215,128 @@ BitInputArchive::BitInputArchive( const BitArchiveHandler& handler, const wstrin
 #else
     mDetectedFormat = &handler.format();
 #endif
-    mInArchive = openArchiveStream( handler, in_file, file_stream );
+    openArchiveFile();
+    applyHandlerOptions( handler );
 }
 
-BitInputArchive::BitInputArchive( const BitArchiveHandler& handler, const vector< byte_t >& in_buffer ) {
+BitInputArchive::BitInputArchive( const BitArchiveHandler& handler, const vector< byte_t >& in_buffer )
+    : mHandler( &handler ), mEncryptedHeaders( false ) {
     auto* buf_stream_spec = new CBufInStream;
     CMyComPtr< IInStream > buf_stream = buf_stream_spec;
     buf_stream_spec->Init( in_buffer.data(), in_buffer.size() );
     mDetectedFormat = &handler.format(); //if auto, detect format from content, otherwise try passed format
     mInArchive = openArchiveStream( handler, L".", buf_stream );
+    applyHandlerOptions( handler );
+}
+
+BitInputArchive::BitInputArchive( const BitArchiveHandler& handler,
+                                  const byte_t* in_buffer,
+                                  size_t in_buffer_size )
+    : mHandler( &handler ), mEncryptedHeaders( false ) {
+    // Note: the buffer is not copied, so it must outlive this object
+    auto* buf_stream_spec = new CBufInStream;
+    CMyComPtr< IInStream > buf_stream = buf_stream_spec;
+    buf_stream_spec->Init( in_buffer, in_buffer_size );
+    mDetectedFormat = &handler.format(); //if auto, detect format from content, otherwise try passed format
+    mInArchive = openArchiveStream( handler, L".", buf_stream );
+    applyHandlerOptions( handler );
 }
 
-BitInputArchive::BitInputArchive( const BitArchiveHandler& handler, std::istream& in_stream ) {
+BitInputArchive::BitInputArchive( const BitArchiveHandler& handler, std::istream& in_stream )
+    : mHandler( &handler ), mEncryptedHeaders( false ) {
     auto* std_stream_spec = new CStdInStream( in_stream );
     CMyComPtr< IInStream > std_stream = std_stream_spec;
     mDetectedFormat = &handler.format(); //if auto, detect format from content, otherwise try passed format
     mInArchive = openArchiveStream( handler, L".", std_stream );
+    applyHandlerOptions( handler );
+}
+
+bool BitInputArchive::useSidecarIndex( const BitArchiveHandler& handler ) const {
+    /* The sidecar index stores the items table in plaintext, hence it is not used for archives whose headers are
+     * encrypted, nor by handlers using a password (which could be needed to read the headers) */
+    return handler.sidecarIndex() && !handler.isPasswordDefined() && !mEncryptedHeaders;
+}
+
+bool BitInputArchive::loadSidecarIndex( const BitArchiveHandler& handler ) {
+    int format_value = 0;
+    unique_ptr< ItemsCache > items_cache = ItemsCache::loadIndexFile( sidecarIndexPath( mArchivePath ),
+                                                                      mArchivePath,
+                                                                      format_value );
+    if ( !items_cache ) {
+        return false;
+    }
+#ifdef BIT7Z_AUTO_FORMAT
+    const BitInFormat& format = ( handler.format() == BitFormat::Auto ?
+                                  BitFormat::findFormatByValue( format_value ) : handler.format() );
+    if ( format == BitFormat::Auto || format.value() != format_value ) {
+        return false;
+    }
+#else
+    const BitInFormat& format = handler.format();
+    if ( format.value() != format_value ) {
+        return false; // the index was saved by a handler using a different format
+    }
+#endif
+    mDetectedFormat = &format;
+    mItemsCache = std::move( items_cache );
+    return true;
+}
+
+void BitInputArchive::openArchiveFile() const {
+    CMyComPtr< IInStream > file_stream;
+    if ( mHandler->memoryMapping() ) {
+        auto* mapping_stream_spec = new CFileMappingInStream;
+        file_stream = mapping_stream_spec;
+        if ( !mapping_stream_spec->Open( mArchivePath.c_str() ) ) {
+            file_stream.Release(); // the file cannot be mapped, falling back to the normal file stream
+        }
+    }
+    if ( !file_stream ) {
+        auto* file_stream_spec = new CInFileStream;
+        file_stream = file_stream_spec;
+        if ( !file_stream_spec->Open( mArchivePath.c_str() ) ) {
+            throw BitException( L"Cannot open archive file '" + mArchivePath + L"'", ERROR_OPEN_FAILED );
+        }
+    }
+    mInArchive = openArchiveStream( *mHandler, mArchivePath, file_stream );
+}
+
+IInArchive* BitInputArchive::inArchive() const {
+    /* If the items were loaded from a sidecar index, the archive is opened the first time it is needed (once, even if
+     * several threads need it at the same time; if the opening fails, it is tried again on the next call) */
+    std::call_once( mOpenFlag, [ this ]() {
+        if ( mInArchive == nullptr ) {
+            openArchiveFile();
+        }
+    });
+    return mInArchive;
+}
+
+void BitInputArchive::applyHandlerOptions( const BitArchiveHandler& handler ) {
+    if ( handler.itemsCaching() || handler.sidecarIndex() ) {
+        try {
+            cacheItemsProperties();
+            if ( useSidecarIndex( handler ) && !mArchivePath.empty() ) {
+                // Note: failing to save the index is not an error, the archive will be simply parsed again next time
+                mItemsCache->saveIndexFile( sidecarIndexPath( mArchivePath ), mArchivePath, mDetectedFormat->value() );
+            }
+        } catch ( ... ) { // the destructor won't be called, so the opened archive must be released here
+            mInArchive->Release();
+            throw;
+        }
+    }
+}
+
+void BitInputArchive::setHandler( const BitArchiveHandler& handler ) {
+    mHandler = &handler;
+    if ( handler.itemsCaching() || handler.sidecarIndex() ) {
+        cacheItemsProperties();
+    }
 }
 
 BitPropVariant BitInputArchive::getArchiveProperty( BitProperty property ) const {
     BitPropVariant propvar;
-    HRESULT res = mInArchive->GetArchiveProperty( static_cast<PROPID>( property ), &propvar );
+    HRESULT res = inArchive()->GetArchiveProperty( static_cast<PROPID>( property ), &propvar );
     if ( res != S_OK ) {
         throw BitException( "Could not retrieve archive property", res );
     }
@@ -137,8 +344,11 @@ BitPropVariant BitInputArchive::getArchiveProperty( BitProperty property ) const
 }
 
 BitPropVariant BitInputArchive::getItemProperty( uint32_t index, BitProperty property ) const {
+    if ( mItemsCache && ItemsCache::isCached( property ) ) {
+        return mItemsCache->itemProperty( index, property );
+    }
     BitPropVariant propvar;
-    HRESULT res = mInArchive->GetProperty( index, static_cast<PROPID>( property ), &propvar );
+    HRESULT res = inArchive()->GetProperty( index, static_cast<PROPID>( property ), &propvar );
     if ( res != S_OK ) {
         throw BitException( L"Could not retrieve property for item at index " + std::to_wstring( index ), res );
     }
@@ -146,8 +356,11 @@ BitPropVariant BitInputArchive::getItemProperty( uint32_t index, BitProperty pro
 }
 
 uint32_t BitInputArchive::itemsCount() const {
+    if ( mItemsCache ) {
+        return mItemsCache->itemsCount();
+    }
     uint32_t items_count;
-    HRESULT res = mInArchive->GetNumberOfItems( &items_count );
+    HRESULT res = inArchive()->GetNumberOfItems( &items_count );
     if ( res != S_OK ) {
         throw BitException( "Could not retrieve the number of items in the archive", res );
     }
@@ -155,41 +368,144 @@ uint32_t BitInputArchive::itemsCount() const {
 }
 
 bool BitInputArchive::isItemFolder( uint32_t index ) const {
+    if ( mItemsCache && index < mItemsCache->itemsCount() ) {
+        return mItemsCache->isItemFolder( index );
+    }
     BitPropVariant prop = getItemProperty( index, BitProperty::IsDir );
     return !prop.isEmpty() && prop.getBool();
 }
 
 bool BitInputArchive::isItemEncrypted( uint32_t index ) const {
+    if ( mItemsCache && index < mItemsCache->itemsCount() ) {
+        return mItemsCache->isItemEncrypted( index );
+    }
     BitPropVariant propvar = getItemProperty( index, BitProperty::Encrypted );
     return propvar.isBool() && propvar.getBool();
 }
 
+wstring BitInputArchive::itemPath( uint32_t index ) const {
+    if ( mItemsCache && index < mItemsCache->itemsCount() ) {
+        return mItemsCache->itemPath( index );
+    }
+    BitPropVariant prop = getItemProperty( index, BitProperty::Path );
+    return prop.isString() ? prop.getString() : wstring();
+}
+
+uint64_t BitInputArchive::plausibleItemSize( uint32_t index ) const {
+    BitPropVariant size = getItemProperty( index, BitProperty::Size );
+    if ( size.isEmpty() ) {
+        return 0;
+    }
+    BitPropVariant pack_size = getItemProperty( index, BitProperty::PackSize );
+    if ( !pack_size.isEmpty() && pack_size.getUInt64() > 0 && // e.g. items of solid blocks may have no packed size
+         size.getUInt64() / kMaxCompressionRatio > pack_size.getUInt64() ) {
+        return 0;
+    }
+    return size.getUInt64();
+}
+
+void BitInputArchive::cacheItemsProperties() {
+    if ( !mItemsCache ) {
+        mItemsCache.reset( new ItemsCache( inArchive() ) );
+    }
+}
+
+bool BitInputArchive::hasCachedItemsProperties() const {
+    return mItemsCache != nullptr;
+}
+
+bool BitInputArchive::findItem( const wstring& path, uint32_t& index, bool case_sensitive ) const {
+    std::once_flag& path_index_flag = case_sensitive ? mPathIndexFlag : mCaseInsensitivePathIndexFlag;
+    unique_ptr< ItemsPathIndex >& path_index = case_sensitive ? mPathIndex : mCaseInsensitivePathIndex;
+    std::call_once( path_index_flag, [ this, &path_index, case_sensitive ]() {
+        path_index.reset( new ItemsPathIndex( *this, case_sensitive ) );
+    });
+    return path_index->find( path, index );
+}
+
+unique_ptr< BitItemReader > BitInputArchive::openItemReader( uint32_t index, size_t buffer_size ) const {
+    if ( index >= itemsCount() ) {
+        throw BitException( L"Index " + std::to_wstring( index ) + L" is out of range", E_INVALIDARG );
+    }
+    if ( isItemFolder( index ) ) {
+        throw BitException( "Cannot read the content of a folder", E_INVALIDARG );
+    }
+    return unique_ptr< BitItemReader >( new BitItemReader( *mHandler, *this, index, buffer_size ) );
+}
+
+void BitInputArchive::readRange( uint32_t index,
+                                 uint64_t offset,
+                                 size_t length,
+                                 vector< byte_t >& out_buffer ) const {
+    if ( index >= itemsCount() ) {
+        throw BitException( L"Index " + std::to_wstring( index ) + L" is out of range", E_INVALIDARG );
+    }
+    if ( isItemFolder( index ) ) {
+        throw BitException( "Cannot read the content of a folder", E_INVALIDARG );
+    }
+
+    out_buffer.clear();
+    BitPropVariant size_prop = getItemProperty( index, BitProperty::Size );
+    if ( !size_prop.isEmpty() ) { // the range is clamped to the (declared) end of the item
+        uint64_t item_size = size_prop.getUInt64();
+        length = offset < item_size ? static_cast< size_t >( std::min< uint64_t >( length, item_size - offset ) ) : 0;
+    }
+    if ( length == 0 ) {
+        return;
+    }
+
+    // Formats like tar allow to read the (non compressed) content of an item directly from the archive stream
+    CMyComPtr< IInArchiveGetStream > get_stream;
+    if ( inArchive()->QueryInterface( ::IID_IInArchiveGetStream, reinterpret_cast< void** >( &get_stream ) ) == S_OK &&
+         get_stream ) {
+        CMyComPtr< ISequentialInStream > item_stream;
+        if ( get_stream->GetStream( index, &item_stream ) == S_OK && item_stream ) {
+            readStreamRange( item_stream, offset, length, out_buffer );
+            return;
+        }
+    }
+
+    // Otherwise, the item must be decoded (at least) until the end of the range
+    RangeVisitor visitor( offset, length, out_buffer );
+    auto* extract_callback_spec = new VisitorExtractCallback( *mHandler, *this, visitor );
+    CMyComPtr< ExtractCallback > extract_callback = extract_callback_spec;
+    try {
+        extract( vector< uint32_t >( 1, index ), extract_callback );
+    } catch ( const BitException& ) {
+        extract_callback_spec->rethrowVisitorException(); // e.g. the range buffer could not be allocated
+        if ( !visitor.isComplete() ) { // i.e. the extraction was not stopped by the visitor
+            throw;
+        }
+    }
+}
+
 HRESULT BitInputArchive::initUpdatableArchive( IOutArchive** newArc ) const {
-    return mInArchive->QueryInterface( ::IID_IOutArchive, reinterpret_cast< void** >( newArc ) );
+    return inArchive()->QueryInterface( ::IID_IOutArchive, reinterpret_cast< void** >( newArc ) );
 }
 
 void BitInputArchive::extract( const vector< uint32_t >& indices, ExtractCallback* extract_callback ) const {
     const uint32_t* item_indices = indices.empty() ? nullptr : indices.data();
     uint32_t num_items = indices.empty() ? static_cast< uint32_t >( -1 ) : static_cast< uint32_t >( indices.size() );
 
-    HRESULT res = mInArchive->Extract( item_indices, num_items, NExtract::NAskMode::kExtract, extract_callback );
+    HRESULT res = inArchive()->Extract( item_indices, num_items, NExtract::NAskMode::kExtract, extract_callback );
     if ( res != S_OK ) {
         throw BitException( extract_callback->getErrorMessage(), res );
     }
 }
 
 void BitInputArchive::test( ExtractCallback* extract_callback ) const {
-    HRESULT res = mInArchive->Extract( nullptr, static_cast< uint32_t >( -1 ), NExtract::NAskMode::kTest, extract_callback );
+    HRESULT res = inArchive()->Extract( nullptr, static_cast< uint32_t >( -1 ), NExtract::NAskMode::kTest, extract_callback );
     if ( res != S_OK ) {
         throw BitException( extract_callback->getErrorMessage(), res );
     }
 }
 
 HRESULT BitInputArchive::close() const {
-    return mInArchive->Close();
+    return mInArchive != nullptr ? mInArchive->Close() : S_OK;
 }
 
 BitInputArchive::~BitInputArchive() {
+    mItemsCache.reset();
     if ( mInArchive ) {
         mInArchive->Release();
     }
@@ -0,0 +1,154 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+/*
+ * bit7z - A C++ static library to interface with the 7-zip DLLs.
+ * Copyright (c) 2014-2019  Riccardo Ostani - All Rights Reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * Bit7z is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with bit7z; if not, see https://www.gnu.org/licenses/.
+ */
+
+#include "../include/bititemreader.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#include "../include/bitchunkvisitor.hpp"
+#include "../include/bitexception.hpp"
+#include "../include/bitinputarchive.hpp"
+#include "../include/visitorextractcallback.hpp"
+
+using namespace bit7z;
+
+class BitItemReader::ProducerVisitor : public BitChunkVisitor {
+    public:
+        explicit ProducerVisitor( BitItemReader& reader ) : mReader( reader ) {}
+
+        bool onChunk( uint32_t /*index*/, const byte_t* data, size_t size ) override {
+            return mReader.write( data, size );
+        }
+
+    private:
+        BitItemReader& mReader;
+};
+
+BitItemReader::BitItemReader( const BitArchiveHandler& handler,
+                              const BitInputArchive& in_archive,
+                              uint32_t index,
+                              size_t buffer_size )
+    : mIndex( index ),
+      mBuffer( std::max( buffer_size, static_cast< size_t >( 1 ) ) ),
+      mReadPosition( 0 ),
+      mAvailable( 0 ),
+      mProducerDone( false ),
+      mCancelled( false ) {
+    // Note: the producer must be started only once all the other members have been initialized
+    mProducer = std::thread( &BitItemReader::produce, this, std::cref( handler ), std::cref( in_archive ) );
+}
+
+BitItemReader::~BitItemReader() {
+    {
+        std::lock_guard< std::mutex > lock( mMutex );
+        mCancelled = true; // if the producer is still decoding, its next write will abort the extraction
+    }
+    mSpaceAvailable.notify_all();
+    if ( mProducer.joinable() ) {
+        mProducer.join();
+    }
+}
+
+uint32_t BitItemReader::index() const {
+    return mIndex;
+}
+
+size_t BitItemReader::read( byte_t* buffer, size_t size ) {
+    if ( size == 0 ) {
+        return 0;
+    }
+
+    std::unique_lock< std::mutex > lock( mMutex );
+    mDataAvailable.wait( lock, [ this ]() -> bool {
+        return mAvailable > 0 || mProducerDone;
+    });
+
+    if ( mAvailable == 0 ) { // i.e. the producer has finished and all the data has been read
+        if ( mError ) {
+            std::rethrow_exception( mError );
+        }
+        return 0;
+    }
+
+    size_t read_size = std::min( size, mAvailable );
+    size_t first_part = std::min( read_size, mBuffer.size() - mReadPosition ); // the data could wrap around
+    std::memcpy( buffer, mBuffer.data() + mReadPosition, first_part );
+    std::memcpy( buffer + first_part, mBuffer.data(), read_size - first_part );
+    mReadPosition = ( mReadPosition + read_size ) % mBuffer.size();
+    mAvailable -= read_size;
+    lock.unlock();
+
+    mSpaceAvailable.notify_one();
+    return read_size;
+}
+
+void BitItemReader::produce( const BitArchiveHandler& handler, const BitInputArchive& in_archive ) {
+    std::exception_ptr error;
+    try {
+        ProducerVisitor visitor( *this );
+        auto* extract_callback_spec = new VisitorExtractCallback( handler, in_archive, visitor );
+        CMyComPtr< ExtractCallback > extract_callback = extract_callback_spec;
+        try {
+            in_archive.extract( vector< uint32_t >( 1, mIndex ), extract_callback );
+        } catch ( const BitException& ) {
+            extract_callback_spec->rethrowVisitorException();
+            throw;
+        }
+    } catch ( ... ) {
+        error = std::current_exception();
+    }
+
+    {
+        std::lock_guard< std::mutex > lock( mMutex );
+        if ( !mCancelled ) { // if the reader was destroyed, the extraction was aborted on purpose
+            mError = error;
+        }
+        mProducerDone = true;
+    }
+    mDataAvailable.notify_all();
+}
+
+bool BitItemReader::write( const byte_t* data, size_t size ) {
+    while ( size > 0 ) {
+        std::unique_lock< std::mutex > lock( mMutex );
+        mSpaceAvailable.wait( lock, [ this ]() -> bool {
+            return mAvailable < mBuffer.size() || mCancelled;
+        });
+
+        if ( mCancelled ) {
+            return false;
+        }
+
+        size_t write_position = ( mReadPosition + mAvailable ) % mBuffer.size();
+        size_t write_size = std::min( size, mBuffer.size() - mAvailable );
+        size_t first_part = std::min( write_size, mBuffer.size() - write_position ); // the data could wrap around
+        std::memcpy( mBuffer.data() + write_position, data, first_part );
+        std::memcpy( mBuffer.data(), data + first_part, write_size - first_part );
+        mAvailable += write_size;
+        lock.unlock();
+
+        mDataAvailable.notify_one();
+        data += write_size;
+        size -= write_size;
+    }
+    return true;
+}
@@ -36,22 +36,49 @@ BitMemCompressor::BitMemCompressor( const Bit7zLibrary& lib, const BitInOutForma
 void BitMemCompressor::compress( const vector< byte_t >& in_buffer,
                                  const wstring& out_file,
                                  const wstring& in_buffer_name ) const {
+    compress( in_buffer.data(), in_buffer.size(), out_file, in_buffer_name );
+}
+
+void BitMemCompressor::compress( const vector< byte_t >& in_buffer,
+                                 vector< byte_t >& out_buffer,
+                                 const wstring& in_buffer_name ) const {
+    compress( in_buffer.data(), in_buffer.size(), out_buffer, in_buffer_name );
+}
+
+void BitMemCompressor::compress( const vector< byte_t >& in_buffer,
+                                 std::ostream& out_stream,
+                                 const std::wstring& in_buffer_name ) const {
+    compress( in_buffer.data(), in_buffer.size(), out_stream, in_buffer_name );
+}
+
+void BitMemCompressor::compress( const byte_t* in_buffer,
+                                 size_t in_buffer_size,
+                                 const wstring& out_file,
+                                 const wstring& in_buffer_name ) const {
     const wstring& name = in_buffer_name.empty() ? fsutil::filename( out_file ) : in_buffer_name;
 
-    CMyComPtr< UpdateCallback > update_callback = new BufferUpdateCallback( *this, in_buffer, name );
+    CMyComPtr< UpdateCallback > update_callback = new BufferUpdateCallback( *this, in_buffer, in_buffer_size, name );
     BitArchiveCreator::compressToFile( out_file, update_callback );
 }
 
-void BitMemCompressor::compress( const vector< byte_t >& in_buffer,
+void BitMemCompressor::compress( const byte_t* in_buffer,
+                                 size_t in_buffer_size,
                                  vector< byte_t >& out_buffer,
                                  const wstring& in_buffer_name ) const {
-    CMyComPtr< UpdateCallback > update_callback = new BufferUpdateCallback( *this, in_buffer, in_buffer_name );
+    CMyComPtr< UpdateCallback > update_callback = new BufferUpdateCallback( *this,
+                                                                            in_buffer,
+                                                                            in_buffer_size,
+                                                                            in_buffer_name );
     BitArchiveCreator::compressToBuffer( out_buffer, update_callback );
 }
 
-void BitMemCompressor::compress( const vector< byte_t >& in_buffer,
+void BitMemCompressor::compress( const byte_t* in_buffer,
+                                 size_t in_buffer_size,
                                  std::ostream& out_stream,
                                  const std::wstring& in_buffer_name ) const {
-    CMyComPtr< UpdateCallback > update_callback = new BufferUpdateCallback( *this, in_buffer, in_buffer_name );
+    CMyComPtr< UpdateCallback > update_callback = new BufferUpdateCallback( *this,
+                                                                            in_buffer,
+                                                                            in_buffer_size,
+                                                                            in_buffer_name );
     BitArchiveCreator::compressToStream( out_stream, update_callback );
 }
@@ -31,29 +31,75 @@ BitMemExtractor::BitMemExtractor( const Bit7zLibrary& lib, const BitInFormat& fo
     : BitArchiveOpener( lib, format ) {}
 
 void BitMemExtractor::extract( const vector< byte_t >& in_buffer, const wstring& out_dir ) const {
-    BitInputArchive in_archive( *this, in_buffer );
-    extractToFileSystem( in_archive, L"", out_dir, vector< uint32_t >() );
+    extract( in_buffer.data(), in_buffer.size(), out_dir );
 }
 
 void BitMemExtractor::extract( const vector< byte_t >& in_buffer,
                                vector< byte_t >& out_buffer,
                                unsigned int index ) const {
-    BitInputArchive in_archive( *this, in_buffer );
-    extractToBuffer( in_archive, out_buffer, index );
+    extract( in_buffer.data(), in_buffer.size(), out_buffer, index );
 }
 
 void BitMemExtractor::extract( const vector<byte_t>& in_buffer, std::ostream& out_stream, unsigned int index ) const {
-    BitInputArchive in_archive( *this, in_buffer );
-    extractToStream( in_archive, out_stream, index );
+    extract( in_buffer.data(), in_buffer.size(), out_stream, index );
 }
 
 void BitMemExtractor::extract( const vector< byte_t >& in_buffer, map< wstring, vector< byte_t > >& out_map ) const {
-    BitInputArchive in_archive( *this, in_buffer );
-    extractToBufferMap( in_archive, out_map );
+    extract( in_buffer.data(), in_buffer.size(), out_map );
+}
+
+void BitMemExtractor::extract( const vector< byte_t >& in_buffer, BitArenaMap& out_arena ) const {
+    extract( in_buffer.data(), in_buffer.size(), out_arena );
+}
+
+void BitMemExtractor::extract( const vector< byte_t >& in_buffer, BitChunkVisitor& visitor ) const {
+    extract( in_buffer.data(), in_buffer.size(), visitor );
 }
 
 void BitMemExtractor::test( const vector< byte_t >& in_buffer ) const {
-    BitInputArchive in_archive( *this, in_buffer );
+    test( in_buffer.data(), in_buffer.size() );
+}
+
+void BitMemExtractor::extract( const byte_t* in_buffer, size_t in_buffer_size, const wstring& out_dir ) const {
+    BitInputArchive in_archive( *this, in_buffer, in_buffer_size );
+    extractToFileSystem( in_archive, L"", out_dir, vector< uint32_t >() );
+}
+
+void BitMemExtractor::extract( const byte_t* in_buffer,
+                               size_t in_buffer_size,
+                               vector< byte_t >& out_buffer,
+                               unsigned int index ) const {
+    BitInputArchive in_archive( *this, in_buffer, in_buffer_size );
+    extractToBuffer( in_archive, out_buffer, index );
+}
+
+void BitMemExtractor::extract( const byte_t* in_buffer,
+                               size_t in_buffer_size,
+                               std::ostream& out_stream,
+                               unsigned int index ) const {
+    BitInputArchive in_archive( *this, in_buffer, in_buffer_size );
+    extractToStream( in_archive, out_stream, index );
+}
+
+void BitMemExtractor::extract( const byte_t* in_buffer,
+                               size_t in_buffer_size,
+                               map< wstring, vector< byte_t > >& out_map ) const {
+    BitInputArchive in_archive( *this, in_buffer, in_buffer_size );
+    extractToBufferMap( in_archive, out_map );
+}
+
+void BitMemExtractor::extract( const byte_t* in_buffer, size_t in_buffer_size, BitArenaMap& out_arena ) const {
+    BitInputArchive in_archive( *this, in_buffer, in_buffer_size );
+    extractToArenaMap( in_archive, out_arena );
+}
+
+void BitMemExtractor::extract( const byte_t* in_buffer, size_t in_buffer_size, BitChunkVisitor& visitor ) const {
+    BitInputArchive in_archive( *this, in_buffer, in_buffer_size );
+    extractToVisitor( in_archive, vector< uint32_t >(), visitor );
+}
+
+void BitMemExtractor::test( const byte_t* in_buffer, size_t in_buffer_size ) const {
+    BitInputArchive in_archive( *this, in_buffer, in_buffer_size );
 
     map< wstring, vector< byte_t > > dummy_map; //output map (not used since we are testing!)
     CMyComPtr< ExtractCallback > extract_callback = new BufferExtractCallback( *this, in_archive, dummy_map );
@@ -50,6 +50,16 @@ void BitStreamExtractor::extract( istream& in_stream, map< wstring, vector< byte
     extractToBufferMap( in_archive, out_map );
 }
 
+void BitStreamExtractor::extract( istream& in_stream, BitArenaMap& out_arena ) const {
+    BitInputArchive in_archive( *this, in_stream );
+    extractToArenaMap( in_archive, out_arena );
+}
+
+void BitStreamExtractor::extract( istream& in_stream, BitChunkVisitor& visitor ) const {
+    BitInputArchive in_archive( *this, in_stream );
+    extractToVisitor( in_archive, vector< uint32_t >(), visitor );
+}
+
 void BitStreamExtractor::test( istream& in_stream ) const {
     BitInputArchive in_archive( *this, in_stream );
 
@@ -62,7 +62,12 @@ STDMETHODIMP BufferExtractCallback::GetStream( UInt32 index, ISequentialOutStrea
 
     if ( !mInputArchive.isItemFolder( index ) ) {
         //Note: using [] operator it creates the buffer if it does not exists already!
-        auto* out_mem_stream_spec = new CBufOutStream( mBuffersMap[ fullPath ] );
+        vector< byte_t >& out_buffer = mBuffersMap[ fullPath ];
+
+        // The whole content is written using a single allocation (if its declared size is plausible)
+        CBufOutStream::reserveBuffer( out_buffer, mInputArchive.plausibleItemSize( index ) );
+
+        auto* out_mem_stream_spec = new CBufOutStream( out_buffer );
         CMyComPtr< ISequentialOutStream > outStreamLoc( out_mem_stream_spec );
         mOutMemStream = outStreamLoc;
         *outStream = outStreamLoc.Detach();
@@ -37,10 +37,12 @@ using namespace bit7z;
  *  + FSItem class is used instead of CDirItem struct */
 
 BufferUpdateCallback::BufferUpdateCallback( const BitArchiveCreator& creator,
-                                      const vector< byte_t >& in_buffer,
+                                      const byte_t* in_buffer,
+                                      size_t in_buffer_size,
                                       const wstring& in_buffer_name )
     : UpdateCallback( creator ),
       mBuffer( in_buffer ),
+      mBufferSize( in_buffer_size ),
       mBufferName( in_buffer_name ) {}
 
 BufferUpdateCallback::~BufferUpdateCallback() {}
@@ -61,7 +63,7 @@ HRESULT BufferUpdateCallback::GetProperty( UInt32 index, PROPID propID, PROPVARI
                 prop = false;
                 break;
             case kpidSize:
-                prop = static_cast< uint64_t >( sizeof( byte_t ) * mBuffer.size() );
+                prop = static_cast< uint64_t >( sizeof( byte_t ) * mBufferSize );
                 break;
             case kpidAttrib:
                 prop = static_cast< uint32_t >( FILE_ATTRIBUTE_NORMAL );
@@ -97,7 +99,7 @@ HRESULT BufferUpdateCallback::GetStream( UInt32 index, ISequentialInStream** inS
 
     auto* inStreamSpec = new CBufInStream;
     CMyComPtr< ISequentialInStream > inStreamLoc( inStreamSpec );
-    inStreamSpec->Init( mBuffer.data(), mBuffer.size() );
+    inStreamSpec->Init( mBuffer, mBufferSize );
 
     *inStream = inStreamLoc.Detach();
     return S_OK;
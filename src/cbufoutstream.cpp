@@ -21,8 +21,22 @@
 
 #include "../include/cbufoutstream.hpp"
 
+#include <algorithm>
+#include <new>
+#include <stdexcept>
+
 using namespace bit7z;
 
+#if ( _MSC_VER <= 1700 )
+#define CONSTEXPR const
+#else
+#define CONSTEXPR constexpr
+#endif
+
+/* Initial capacity of a buffer whose content size is unknown (i.e. a buffer not reserved in advance): this avoids
+ * the many small reallocations of the first writes */
+CONSTEXPR auto kMinBufferCapacity = static_cast< size_t >( 64 * 1024 );
+
 CBufOutStream::CBufOutStream( vector< byte_t >& out_buffer ) : mBuffer( out_buffer ) {}
 
 CBufOutStream::~CBufOutStream() {};
@@ -35,9 +49,25 @@ STDMETHODIMP CBufOutStream::Write( const void* data, UInt32 size, UInt32* proces
         return E_FAIL;
     }
     const auto* byte_data = static_cast< const byte_t* >( data );
+    size_t required_size = mBuffer.size() + size;
+    if ( required_size > mBuffer.capacity() ) { // growing geometrically, starting from a reasonably sized chunk
+        size_t min_capacity = mBuffer.capacity() == 0 ? kMinBufferCapacity : 2 * mBuffer.capacity();
+        mBuffer.reserve( std::max( required_size, min_capacity ) );
+    }
     mBuffer.insert( mBuffer.end(), byte_data, byte_data + size );
     if ( processedSize != nullptr ) {
         *processedSize = size;
     }
     return S_OK;
 }
+
+void CBufOutStream::reserveBuffer( vector< byte_t >& buffer, uint64_t size ) {
+    if ( size > buffer.max_size() ) {
+        return;
+    }
+    try {
+        buffer.reserve( static_cast< size_t >( size ) );
+    } catch ( const std::bad_alloc& ) {
+        // Not an error: the buffer will grow as the content is being written
+    } catch ( const std::length_error& ) {}
+}
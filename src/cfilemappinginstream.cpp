@@ -0,0 +1,140 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+/*
+ * bit7z - A C++ static library to interface with the 7-zip DLLs.
+ * Copyright (c) 2014-2019  Riccardo Ostani - All Rights Reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * Bit7z is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with bit7z; if not, see https://www.gnu.org/licenses/.
+ */
+
+#include "../include/cfilemappinginstream.hpp"
+
+#include <cstring>
+
+using namespace bit7z;
+
+CFileMappingInStream::CFileMappingInStream()
+    : mFile( INVALID_HANDLE_VALUE ), mMapping( nullptr ), mView( nullptr ), mSize( 0 ), mPosition( 0 ) {}
+
+CFileMappingInStream::~CFileMappingInStream() {
+    close();
+}
+
+bool CFileMappingInStream::Open( const wchar_t* file_name ) {
+    close();
+
+    mFile = CreateFileW( file_name, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL,
+                         nullptr );
+    if ( mFile == INVALID_HANDLE_VALUE ) {
+        return false;
+    }
+
+    LARGE_INTEGER file_size;
+    if ( !GetFileSizeEx( mFile, &file_size ) || file_size.QuadPart <= 0 ||
+         static_cast< uint64_t >( file_size.QuadPart ) > static_cast< uint64_t >( SIZE_MAX ) ) {
+        close(); // empty files cannot be mapped, while too big ones do not fit in the address space of the process
+        return false;
+    }
+    mSize = static_cast< uint64_t >( file_size.QuadPart );
+
+    mMapping = CreateFileMappingW( mFile, nullptr, PAGE_READONLY, 0, 0, nullptr );
+    if ( mMapping == nullptr ) {
+        close();
+        return false;
+    }
+
+    mView = static_cast< const uint8_t* >( MapViewOfFile( mMapping, FILE_MAP_READ, 0, 0, 0 ) );
+    if ( mView == nullptr ) {
+        close();
+        return false;
+    }
+    mPosition = 0;
+    return true;
+}
+
+void CFileMappingInStream::close() {
+    if ( mView != nullptr ) {
+        UnmapViewOfFile( mView );
+        mView = nullptr;
+    }
+    if ( mMapping != nullptr ) {
+        CloseHandle( mMapping );
+        mMapping = nullptr;
+    }
+    if ( mFile != INVALID_HANDLE_VALUE ) {
+        CloseHandle( mFile );
+        mFile = INVALID_HANDLE_VALUE;
+    }
+    mSize = 0;
+    mPosition = 0;
+}
+
+STDMETHODIMP CFileMappingInStream::Read( void* data, uint32_t size, uint32_t* processedSize ) {
+    if ( processedSize ) {
+        *processedSize = 0;
+    }
+
+    if ( size == 0 || mPosition >= mSize ) {
+        return S_OK;
+    }
+
+    uint64_t remaining = mSize - mPosition;
+    uint32_t read_size = remaining < size ? static_cast< uint32_t >( remaining ) : size;
+
+#ifdef _MSC_VER
+    /* Accessing a mapped view of a file raises an exception if the file cannot be read
+     * (e.g. it was truncated by another process, or a network drive was disconnected) */
+    __try {
+        std::memcpy( data, mView + mPosition, read_size );
+    } __except ( GetExceptionCode() == EXCEPTION_IN_PAGE_ERROR ? EXCEPTION_EXECUTE_HANDLER : EXCEPTION_CONTINUE_SEARCH ) {
+        return HRESULT_FROM_WIN32( ERROR_READ_FAULT );
+    }
+#else
+    std::memcpy( data, mView + mPosition, read_size );
+#endif
+    mPosition += read_size;
+
+    if ( processedSize ) {
+        *processedSize = read_size;
+    }
+    return S_OK;
+}
+
+STDMETHODIMP CFileMappingInStream::Seek( int64_t offset, uint32_t seekOrigin, uint64_t* newPosition ) {
+    int64_t base;
+    switch ( seekOrigin ) {
+        case STREAM_SEEK_SET:
+            base = 0;
+            break;
+        case STREAM_SEEK_CUR:
+            base = static_cast< int64_t >( mPosition );
+            break;
+        case STREAM_SEEK_END:
+            base = static_cast< int64_t >( mSize );
+            break;
+        default:
+            return STG_E_INVALIDFUNCTION;
+    }
+
+    if ( offset < -base ) {
+        return HRESULT_FROM_WIN32( ERROR_NEGATIVE_SEEK );
+    }
+
+    mPosition = static_cast< uint64_t >( base + offset ); // seeking beyond the end is allowed (reads return 0 bytes)
+    if ( newPosition ) {
+        *newPosition = mPosition;
+    }
+    return S_OK;
+}
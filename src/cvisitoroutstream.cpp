@@ -0,0 +1,57 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+/*
+ * bit7z - A C++ static library to interface with the 7-zip DLLs.
+ * Copyright (c) 2014-2019  Riccardo Ostani - All Rights Reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * Bit7z is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with bit7z; if not, see https://www.gnu.org/licenses/.
+ */
+
+#include "../include/cvisitoroutstream.hpp"
+
+using namespace bit7z;
+
+CVisitorOutStream::CVisitorOutStream( BitChunkVisitor& visitor,
+                                      uint32_t index,
+                                      bool& aborted,
+                                      std::exception_ptr& visitor_exception )
+    : mVisitor( visitor ), mIndex( index ), mAborted( aborted ), mVisitorException( visitor_exception ) {}
+
+CVisitorOutStream::~CVisitorOutStream() {}
+
+STDMETHODIMP CVisitorOutStream::Write( const void* data, UInt32 size, UInt32* processedSize ) {
+    if ( processedSize != nullptr ) {
+        *processedSize = 0;
+    }
+    if ( data == nullptr || size == 0 ) {
+        return E_FAIL;
+    }
+    // Note: exceptions thrown by the visitor must not propagate through the archive handler
+    bool proceed;
+    try {
+        proceed = mVisitor.onChunk( mIndex, static_cast< const byte_t* >( data ), size );
+    } catch ( ... ) {
+        mVisitorException = std::current_exception();
+        proceed = false;
+    }
+    if ( !proceed ) {
+        mAborted = true;
+        return E_ABORT;
+    }
+    if ( processedSize != nullptr ) {
+        *processedSize = size;
+    }
+    return S_OK;
+}
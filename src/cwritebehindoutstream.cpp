@@ -0,0 +1,84 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+/*
+ * bit7z - A C++ static library to interface with the 7-zip DLLs.
+ * Copyright (c) 2014-2019  Riccardo Ostani - All Rights Reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * Bit7z is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with bit7z; if not, see https://www.gnu.org/licenses/.
+ */
+
+#include "../include/cwritebehindoutstream.hpp"
+
+#include <algorithm>
+
+using namespace bit7z;
+
+CWriteBehindOutStream::CWriteBehindOutStream( WriteBehindQueue& queue,
+                                              COutFileStream* file_stream_spec,
+                                              const wstring& path,
+                                              uint64_t preallocated_size )
+    : mQueue( queue ),
+      mFile( queue.addFile( file_stream_spec, path, preallocated_size ) ),
+      mChunk( queue.acquireBuffer() ) {}
+
+CWriteBehindOutStream::~CWriteBehindOutStream() {}
+
+STDMETHODIMP CWriteBehindOutStream::Write( const void* data, UInt32 size, UInt32* processedSize ) {
+    if ( processedSize != nullptr ) {
+        *processedSize = 0;
+    }
+    if ( data == nullptr || size == 0 ) {
+        return E_FAIL;
+    }
+    const auto* byte_data = static_cast< const byte_t* >( data );
+    const size_t chunk_size = mQueue.chunkSize();
+    UInt32 remaining_size = size;
+    while ( remaining_size > 0 ) {
+        size_t copy_size = std::min< size_t >( remaining_size, chunk_size - mChunk.size() );
+        mChunk.insert( mChunk.end(), byte_data, byte_data + copy_size );
+        byte_data += copy_size;
+        remaining_size -= static_cast< UInt32 >( copy_size );
+        if ( mChunk.size() == chunk_size ) {
+            HRESULT res = mQueue.write( mFile, mChunk );
+            if ( res != S_OK ) {
+                return res;
+            }
+            mChunk = mQueue.acquireBuffer();
+        }
+    }
+    if ( processedSize != nullptr ) {
+        *processedSize = size;
+    }
+    return S_OK;
+}
+
+HRESULT CWriteBehindOutStream::Close( const FILETIME* mtime, const UInt32* attrib ) {
+    HRESULT res = S_OK;
+    if ( !mChunk.empty() ) {
+        res = mQueue.write( mFile, mChunk );
+    }
+    // Note: the metadata is set by the writer thread, only once all the data has been written
+    if ( mtime != nullptr ) {
+        mFile->mtimeDefined = true;
+        mFile->mtime = *mtime;
+    }
+    if ( attrib != nullptr ) {
+        mFile->attribDefined = true;
+        mFile->attrib = *attrib;
+    }
+    // Note: the file is closed (and its unused preallocated space is truncated) even if its last chunk was not written
+    HRESULT close_res = mQueue.close( mFile );
+    return res != S_OK ? res : close_res;
+}
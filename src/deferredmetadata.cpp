@@ -0,0 +1,107 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+/*
+ * bit7z - A C++ static library to interface with the 7-zip DLLs.
+ * Copyright (c) 2014-2019  Riccardo Ostani - All Rights Reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * Bit7z is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with bit7z; if not, see https://www.gnu.org/licenses/.
+ */
+
+#include "../include/deferredmetadata.hpp"
+
+#include <algorithm>
+
+#include "../include/parallelfor.hpp"
+
+#include "Windows/FileDir.h"
+
+using namespace bit7z;
+using namespace NWindows;
+
+#if ( _MSC_VER <= 1700 )
+#define CONSTEXPR const
+#else
+#define CONSTEXPR constexpr
+#endif
+
+// Number of files whose metadata is applied by each task of the final pass
+CONSTEXPR auto kFilesPerBatch = 256u;
+
+DeferredMetadata::DeferredMetadata() {}
+
+void DeferredMetadata::addFile( const wstring& path, const FILETIME* mtime, const uint32_t* attrib ) {
+    if ( mtime == nullptr && attrib == nullptr ) {
+        return;
+    }
+    std::lock_guard< std::mutex > lock( mMutex );
+    mFiles.push_back( makeEntry( path, mtime, attrib ) );
+}
+
+void DeferredMetadata::addDirectory( const wstring& path, const FILETIME* mtime, const uint32_t* attrib ) {
+    if ( mtime == nullptr && attrib == nullptr ) {
+        return;
+    }
+    std::lock_guard< std::mutex > lock( mMutex );
+    mDirectories.push_back( makeEntry( path, mtime, attrib ) );
+}
+
+void DeferredMetadata::apply() {
+    std::lock_guard< std::mutex > lock( mMutex );
+
+    // Files are independent of each other, hence their metadata is applied in parallel batches
+    const size_t batches_count = ( mFiles.size() + kFilesPerBatch - 1 ) / kFilesPerBatch;
+    parallelFor( batches_count, 0, [ this ]( size_t batch ) {
+        const size_t first = batch * kFilesPerBatch;
+        const size_t last = std::min( first + kFilesPerBatch, mFiles.size() );
+        for ( size_t i = first; i < last; ++i ) {
+            applyEntry( mFiles[ i ] );
+        }
+    });
+    mFiles.clear();
+
+    // Folders are processed bottom-up (i.e. the deepest ones first)
+    auto depth = []( const Entry& entry ) {
+        return std::count( entry.path.begin(), entry.path.end(), WCHAR_PATH_SEPARATOR );
+    };
+    std::stable_sort( mDirectories.begin(), mDirectories.end(), [ &depth ]( const Entry& a, const Entry& b ) {
+        return depth( a ) > depth( b );
+    });
+    for ( const auto& directory : mDirectories ) {
+        applyEntry( directory );
+    }
+    mDirectories.clear();
+}
+
+DeferredMetadata::Entry DeferredMetadata::makeEntry( const wstring& path,
+                                                     const FILETIME* mtime,
+                                                     const uint32_t* attrib ) {
+    Entry entry;
+    entry.path = path;
+    entry.mtimeDefined = mtime != nullptr;
+    entry.mtime = mtime != nullptr ? *mtime : FILETIME();
+    entry.attribDefined = attrib != nullptr;
+    entry.attrib = attrib != nullptr ? *attrib : 0;
+    return entry;
+}
+
+void DeferredMetadata::applyEntry( const Entry& entry ) {
+    // Note: as when applied during the extraction, failures in setting the metadata are not reported
+    if ( entry.mtimeDefined ) {
+        NFile::NDir::SetDirTime( entry.path.c_str(), nullptr, nullptr, &entry.mtime );
+    }
+    if ( entry.attribDefined ) {
+        NFile::NDir::SetFileAttrib( entry.path.c_str(), entry.attrib );
+    }
+}
@@ -21,6 +21,7 @@
 
 #include "../include/fileextractcallback.hpp"
 
+#include "../C/7zCrc.h"
 #include "Windows/FileDir.h"
 #include "Windows/FileFind.h"
 
@@ -32,6 +33,57 @@ using namespace std;
 using namespace NWindows;
 using namespace bit7z;
 
+namespace {
+    struct CRCTableInitializer {
+        CRCTableInitializer() {
+            CrcGenerateTable();
+        }
+    };
+
+    const CRCTableInitializer kCRCTableInitializer;
+
+    bool computeFileCRC( const wstring& path, uint32_t& crc ) {
+        auto* file_stream_spec = new CInFileStream;
+        CMyComPtr< IInStream > file_stream = file_stream_spec;
+        if ( !file_stream_spec->Open( path.c_str() ) ) {
+            return false;
+        }
+        vector< unsigned char > buffer( 64 * 1024 );
+        UInt32 file_crc = CRC_INIT_VAL;
+        for ( ;; ) {
+            UInt32 processed_size = 0;
+            if ( file_stream->Read( buffer.data(), static_cast< UInt32 >( buffer.size() ), &processed_size ) != S_OK ) {
+                return false;
+            }
+            if ( processed_size == 0 ) {
+                break;
+            }
+            file_crc = CrcUpdate( file_crc, buffer.data(), processed_size );
+        }
+        crc = CRC_GET_DIGEST( file_crc );
+        return true;
+    }
+
+    // Returns the first path not used by any file, among "name_1.ext", "name_2.ext", ...
+    wstring nextAvailablePath( const wstring& path ) {
+        size_t name_start = path.find_last_of( L"\\/" ) + 1;
+        size_t dot_pos = path.find_last_of( L'.' );
+        if ( dot_pos == wstring::npos || dot_pos <= name_start ) { // no extension (or a dot file, e.g. ".config")
+            dot_pos = path.size();
+        }
+        wstring stem = path.substr( 0, dot_pos );
+        wstring extension = path.substr( dot_pos );
+        wstring new_path;
+        NFile::NFind::CFileInfo fi;
+        for ( unsigned int i = 1; ; ++i ) {
+            new_path = stem + L"_" + std::to_wstring( i ) + extension;
+            if ( !fi.Find( new_path.c_str() ) ) {
+                return new_path;
+            }
+        }
+    }
+}
+
 /* Most of this code, though heavily modified, is taken from the CExtractCallback class in Client7z.cpp of the 7z SDK
  * Main changes made:
  *  + Use of wstring instead of UString
@@ -40,25 +92,37 @@ using namespace bit7z;
  *    because it must implement interfaces with nothrow methods.
  *  + The work performed originally by the Init method is now performed by the class constructor */
 
-FileExtractCallback::FileExtractCallback( const BitArchiveHandler& handler,
+FileExtractCallback::FileExtractCallback( const BitArchiveOpener& opener,
                                           const BitInputArchive& inputArchive,
                                           const wstring& inFilePath,
-                                          const wstring& directoryPath )
-    : ExtractCallback( handler, inputArchive ),
+                                          const wstring& directoryPath,
+                                          WriteBehindQueue* writeBehindQueue,
+                                          DeferredMetadata* deferredMetadata )
+    : ExtractCallback( opener, inputArchive ),
       mInFilePath( inFilePath ),
       mDirectoryPath( directoryPath ),
+      mOverwriteMode( opener.overwriteMode() ),
+      mCrcComparison( opener.crcComparison() ),
+      mPreallocationThreshold( opener.preallocationThreshold() ),
+      mPreallocatedSize( 0 ),
       mProcessedFileInfo(),
-      mOutFileStreamSpec( nullptr ) {
+      mOutFileStreamSpec( nullptr ),
+      mWriteBehindStreamSpec( nullptr ),
+      mWriteBehindQueue( writeBehindQueue ),
+      mDeferredMetadata( deferredMetadata ) {
     //NFile::NName::NormalizeDirPathPrefix( mDirectoryPath );
     filesystem::fsutil::normalizePath( mDirectoryPath );
 }
 
-FileExtractCallback::~FileExtractCallback() {}
+FileExtractCallback::~FileExtractCallback() {
+    closeAbortedFile();
+}
 
 //TODO: clean and optimize!
 STDMETHODIMP FileExtractCallback::GetStream( UInt32 index, ISequentialOutStream** outStream, Int32 askExtractMode ) try {
     *outStream = nullptr;
-    mOutFileStream.Release();
+    closeAbortedFile();
+    mPreallocatedSize = 0;
     // Get Name
     BitPropVariant prop = mInputArchive.getItemProperty( index, BitProperty::Path );
 
@@ -114,34 +178,68 @@ STDMETHODIMP FileExtractCallback::GetStream( UInt32 index, ISequentialOutStream*
     size_t slashPos = mFilePath.rfind( WCHAR_PATH_SEPARATOR );
 
     if ( slashPos != wstring::npos ) {
-        NFile::NDir::CreateComplexDir( ( mDirectoryPath + mFilePath.substr( 0, slashPos ) ).c_str() );
+        createDirectory( mFilePath.substr( 0, slashPos ) );
     }
     wstring fullProcessedPath = mDirectoryPath + mFilePath;
     mDiskFilePath = fullProcessedPath;
 
     if ( mProcessedFileInfo.isDir ) {
-        NFile::NDir::CreateComplexDir( fullProcessedPath.c_str() );
+        createDirectory( mFilePath );
     } else {
-        NFile::NFind::CFileInfo fi;
+        if ( mOverwriteMode != BitOverwriteMode::OVERWRITE ) {
+            NFile::NFind::CFileInfo fi;
+            if ( fi.Find( fullProcessedPath.c_str() ) ) {
+                if ( mOverwriteMode == BitOverwriteMode::RENAME ) {
+                    fullProcessedPath = nextAvailablePath( fullProcessedPath );
+                    mDiskFilePath = fullProcessedPath;
+                } else if ( mOverwriteMode == BitOverwriteMode::SKIP ||
+                            ( !fi.IsDir() && isIdenticalFile( index, fi.Size, fi.MTime ) ) ) {
+                    // The existing file is kept as it is: no output stream, and no metadata to be set later
+                    mProcessedFileInfo.AttribDefined = false;
+                    mProcessedFileInfo.MTimeDefined = false;
+                    return S_OK;
+                }
+            }
+        }
 
         if ( mHandler.fileCallback() ) {
             wstring filename = filesystem::fsutil::filename( fullProcessedPath, true );
             mHandler.fileCallback()( filename );
         }
 
-        if ( fi.Find( fullProcessedPath.c_str() ) ) {
-            if ( !NFile::NDir::DeleteFileAlways( fullProcessedPath.c_str() ) ) {
-                mErrorMessage = L"Cannot delete output file " + fullProcessedPath;
+        mOutFileStreamSpec = new COutFileStream;
+        CMyComPtr< ISequentialOutStream > outStreamLoc( mOutFileStreamSpec );
+
+        /* Note: CREATE_ALWAYS already overwrites existing files, hence the output file is deleted (and its
+         * existence checked) only if it cannot be opened (e.g. it is a read-only file) */
+        if ( !mOutFileStreamSpec->Open( fullProcessedPath.c_str(), CREATE_ALWAYS ) ) {
+            NFile::NFind::CFileInfo fi;
+            if ( fi.Find( fullProcessedPath.c_str() ) ) {
+                if ( !NFile::NDir::DeleteFileAlways( fullProcessedPath.c_str() ) ) {
+                    mErrorMessage = L"Cannot delete output file " + fullProcessedPath;
+                    return E_ABORT;
+                }
+            }
+            if ( !mOutFileStreamSpec->Open( fullProcessedPath.c_str(), CREATE_ALWAYS ) ) {
+                mErrorMessage = L"Cannot open output file " + fullProcessedPath;
                 return E_ABORT;
             }
         }
 
-        mOutFileStreamSpec = new COutFileStream;
-        CMyComPtr< ISequentialOutStream > outStreamLoc( mOutFileStreamSpec );
+        if ( mPreallocationThreshold > 0 ) {
+            UInt64 preallocation_size = preallocationSize( index, fullProcessedPath );
+            if ( preallocation_size > 0 &&
+                 mOutFileStreamSpec->SetSize( preallocation_size ) == S_OK ) { // a failed preallocation is not an error
+                mPreallocatedSize = preallocation_size;
+            }
+        }
 
-        if ( !mOutFileStreamSpec->Open( fullProcessedPath.c_str(), CREATE_ALWAYS ) ) {
-            mErrorMessage = L"Cannot open output file " + fullProcessedPath;
-            return E_ABORT;
+        if ( mWriteBehindQueue != nullptr ) { // the file will be written (and closed) by the writer threads
+            mWriteBehindStreamSpec = new CWriteBehindOutStream( *mWriteBehindQueue,
+                                                                mOutFileStreamSpec,
+                                                                fullProcessedPath,
+                                                                mPreallocatedSize );
+            outStreamLoc = mWriteBehindStreamSpec;
         }
 
         mOutFileStream = outStreamLoc;
@@ -153,6 +251,71 @@ STDMETHODIMP FileExtractCallback::GetStream( UInt32 index, ISequentialOutStream*
     return E_OUTOFMEMORY;
 }
 
+void FileExtractCallback::createDirectory( const wstring& dir_path ) {
+    if ( mCreatedDirectories.find( dir_path ) != mCreatedDirectories.end() ) {
+        return;
+    }
+    if ( !NFile::NDir::CreateComplexDir( ( mDirectoryPath + dir_path ).c_str() ) ) {
+        return; // the error will be reported when creating the files inside the folder
+    }
+    // All the ancestors of the folder have been created as well (or they already existed)
+    size_t pos = dir_path.size();
+    do {
+        if ( !mCreatedDirectories.insert( dir_path.substr( 0, pos ) ).second ) {
+            break; // the ancestors of an already created folder are already in the set
+        }
+        pos = dir_path.rfind( WCHAR_PATH_SEPARATOR, pos - 1 );
+    } while ( pos != wstring::npos && pos > 0 );
+}
+
+/* The size of an item is declared by the archive, hence it cannot be trusted: the output file is preallocated only if
+ * the size is plausible with respect to the packed size of the item, and if it fits in the free space of the disk. */
+UInt64 FileExtractCallback::preallocationSize( UInt32 index, const wstring& file_path ) const {
+    uint64_t size = mInputArchive.plausibleItemSize( index );
+    if ( size == 0 || size < mPreallocationThreshold ) {
+        return 0;
+    }
+    ULARGE_INTEGER free_space;
+    wstring dir_path = file_path.substr( 0, file_path.find_last_of( L"\\/" ) + 1 );
+    if ( !GetDiskFreeSpaceExW( dir_path.c_str(), &free_space, nullptr, nullptr ) || size > free_space.QuadPart ) {
+        return 0;
+    }
+    return size;
+}
+
+/* Closes the output file of an item whose extraction was aborted (i.e., SetOperationResult was not called for it),
+ * truncating the preallocated space that was not written. */
+void FileExtractCallback::closeAbortedFile() {
+    if ( mOutFileStream == nullptr ) {
+        return;
+    }
+    if ( mWriteBehindStreamSpec != nullptr ) { // the file is truncated and closed by a writer thread
+        mWriteBehindStreamSpec->Close( nullptr, nullptr );
+        mWriteBehindStreamSpec = nullptr;
+    } else if ( mPreallocatedSize != 0 && mOutFileStreamSpec->ProcessedSize != mPreallocatedSize ) {
+        mOutFileStreamSpec->SetSize( mOutFileStreamSpec->ProcessedSize );
+    }
+    mOutFileStream.Release();
+}
+
+bool FileExtractCallback::isIdenticalFile( UInt32 index, UInt64 file_size, const FILETIME& file_mtime ) const {
+    if ( !mProcessedFileInfo.MTimeDefined ||
+         file_mtime.dwLowDateTime != mProcessedFileInfo.MTime.dwLowDateTime ||
+         file_mtime.dwHighDateTime != mProcessedFileInfo.MTime.dwHighDateTime ) {
+        return false;
+    }
+    BitPropVariant size = mInputArchive.getItemProperty( index, BitProperty::Size );
+    if ( size.isEmpty() || size.getUInt64() != file_size ) {
+        return false;
+    }
+    if ( mCrcComparison ) {
+        BitPropVariant crc = mInputArchive.getItemProperty( index, BitProperty::CRC );
+        uint32_t file_crc = 0;
+        return !crc.isEmpty() && computeFileCRC( mDiskFilePath, file_crc ) && crc.getUInt32() == file_crc;
+    }
+    return true;
+}
+
 STDMETHODIMP FileExtractCallback::SetOperationResult( Int32 operationResult ) {
     switch ( operationResult ) {
         case NArchive::NExtract::NOperationResult::kOK:
@@ -180,17 +343,40 @@ STDMETHODIMP FileExtractCallback::SetOperationResult( Int32 operationResult ) {
         }
     }
 
+    bool closed_by_writer = false;
     if ( mOutFileStream != nullptr ) {
-        if ( mProcessedFileInfo.MTimeDefined ) {
-            mOutFileStreamSpec->SetMTime( &mProcessedFileInfo.MTime );
-        }
+        if ( mWriteBehindStreamSpec != nullptr ) {
+            // The file is closed and its metadata is set by a writer thread, once all its data has been written
+            const FILETIME* mtime = mProcessedFileInfo.MTimeDefined ? &mProcessedFileInfo.MTime : nullptr;
+            const UInt32* attrib = mProcessedFileInfo.AttribDefined && mDeferredMetadata == nullptr ?
+                                   &mProcessedFileInfo.Attrib : nullptr;
+            RINOK( mWriteBehindStreamSpec->Close( mtime, attrib ) );
+            mWriteBehindStreamSpec = nullptr;
+            closed_by_writer = true;
+        } else {
+            // Truncating the preallocated space not used (e.g. the item size was wrong, or the extraction failed)
+            if ( mPreallocatedSize != 0 && mOutFileStreamSpec->ProcessedSize != mPreallocatedSize ) {
+                mOutFileStreamSpec->SetSize( mOutFileStreamSpec->ProcessedSize );
+            }
+            if ( mProcessedFileInfo.MTimeDefined ) {
+                mOutFileStreamSpec->SetMTime( &mProcessedFileInfo.MTime );
+            }
 
-        RINOK( mOutFileStreamSpec->Close() );
+            RINOK( mOutFileStreamSpec->Close() );
+        }
     }
 
     mOutFileStream.Release();
 
-    if ( mExtractMode && mProcessedFileInfo.AttribDefined ) {
+    if ( mExtractMode && mDeferredMetadata != nullptr ) {
+        const UInt32* attrib = mProcessedFileInfo.AttribDefined ? &mProcessedFileInfo.Attrib : nullptr;
+        if ( mProcessedFileInfo.isDir ) {
+            const FILETIME* mtime = mProcessedFileInfo.MTimeDefined ? &mProcessedFileInfo.MTime : nullptr;
+            mDeferredMetadata->addDirectory( mDiskFilePath, mtime, attrib );
+        } else { // the modification time of the file has already been set on its (open) stream
+            mDeferredMetadata->addFile( mDiskFilePath, nullptr, attrib );
+        }
+    } else if ( mExtractMode && mProcessedFileInfo.AttribDefined && !closed_by_writer ) {
         NFile::NDir::SetFileAttrib( mDiskFilePath.c_str(), mProcessedFileInfo.Attrib );
     }
 
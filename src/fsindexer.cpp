@@ -26,7 +26,8 @@
 
 using namespace bit7z::filesystem;
 
-FSIndexer::FSIndexer( const wstring& directory, const wstring& filter ) : mDirItem( directory ), mFilter( filter ) {
+FSIndexer::FSIndexer( const wstring& directory, const wstring& filter )
+    : mDirItem( directory ), mFilter( filter ), mFilterPattern( filter ) {
     if ( !mDirItem.isDir() ) {
         throw BitException( L"'" + mDirItem.name() + L"' is not a directory!", ERROR_DIRECTORY );
     }
@@ -60,7 +61,7 @@ void FSIndexer::listDirectoryItems( vector< FSItem >& result, bool recursive, co
             continue;
         }
 
-        bool item_matches = fsutil::wildcardMatch( mFilter, current_item.name() );
+        bool item_matches = mFilterPattern.matches( current_item.name() );
         if ( item_matches ) {
             result.push_back( current_item );
         }
@@ -20,6 +20,7 @@
  */
 
 #include "../include/fsutil.hpp"
+#include "../include/wildcardpattern.hpp"
 
 #include <Windows.h>
 
@@ -71,37 +72,17 @@ bool fsutil::isRelativePath( const wstring& path ) {
     return path.empty() || ( path.find_first_of( L"/\\" ) != 0 && !( path.length() >= 2 && path[ 1 ] == L':' ) );
 }
 
-// Modified version of code found here: https://stackoverflow.com/a/3300547
-bool w_match( const wchar_t* needle, const wchar_t* haystack, size_t max ) {
-    for ( ; *needle != L'\0'; ++needle ) {
-        switch ( *needle ) {
-            case L'?':
-                if ( *haystack == L'\0' ) {
-                    return false;
-                }
-                ++haystack;
-                break;
-            case L'*': {
-                if ( needle[ 1 ] == L'\0' ) {
-                    return true;
-                }
-                for ( size_t i = 0; i < max; i++ ) {
-                    if ( w_match( needle + 1, haystack + i, max - i ) ) {
-                        return true;
-                    }
-                }
-                return false;
-            }
-            default:
-                if ( *haystack != *needle ) {
-                    return false;
-                }
-                ++haystack;
-        }
-    }
-    return *haystack == L'\0';
+bool fsutil::wildcardMatch( const wstring& pattern, const wstring& str ) {
+    return WildcardPattern( pattern ).matches( str );
 }
 
-bool fsutil::wildcardMatch( const wstring& pattern, const wstring& str ) {
-    return w_match( pattern.empty() ? L"*" : pattern.c_str(), str.c_str(), str.size() );
+bool fsutil::getFileStamp( const wstring& path, uint64_t& size, uint64_t& last_write_time ) {
+    WIN32_FILE_ATTRIBUTE_DATA file_data;
+    if ( GetFileAttributesEx( path.c_str(), GetFileExInfoStandard, &file_data ) == FALSE ) {
+        return false;
+    }
+    size = ( static_cast< uint64_t >( file_data.nFileSizeHigh ) << 32u ) | file_data.nFileSizeLow;
+    last_write_time = ( static_cast< uint64_t >( file_data.ftLastWriteTime.dwHighDateTime ) << 32u ) |
+                      file_data.ftLastWriteTime.dwLowDateTime;
+    return true;
 }
@@ -0,0 +1,110 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+/*
+ * bit7z - A C++ static library to interface with the 7-zip DLLs.
+ * Copyright (c) 2014-2019  Riccardo Ostani - All Rights Reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * Bit7z is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with bit7z; if not, see https://www.gnu.org/licenses/.
+ */
+
+#include "../include/indexedextractcallback.hpp"
+
+#include <algorithm>
+
+#include "../include/cbufoutstream.hpp"
+#include "../include/bitpropvariant.hpp"
+#include "../include/bitexception.hpp"
+
+using namespace std;
+using namespace bit7z;
+
+const uint32_t IndexedExtractCallback::kNoSlot;
+
+IndexedExtractCallback::IndexedExtractCallback( const BitArchiveHandler& handler,
+                                                const BitInputArchive& inputArchive,
+                                                const vector< Slot >& slots,
+                                                vector< vector< byte_t > >& buffers )
+    : ExtractCallback( handler, inputArchive ),
+      mSlots( slots ),
+      mBuffers( buffers ) {}
+
+IndexedExtractCallback::~IndexedExtractCallback() {}
+
+uint32_t IndexedExtractCallback::findSlot( const vector< Slot >& slots, uint32_t index ) {
+    auto it = std::lower_bound( slots.begin(), slots.end(), Slot( index, 0 ) );
+    return it != slots.end() && it->first == index ? it->second : kNoSlot;
+}
+
+STDMETHODIMP IndexedExtractCallback::GetStream( UInt32 index, ISequentialOutStream** outStream, Int32 askExtractMode ) try {
+    *outStream = nullptr;
+    mOutMemStream.Release();
+
+    if ( askExtractMode != NArchive::NExtract::NAskMode::kExtract ) {
+        return S_OK;
+    }
+
+    uint32_t slot = findSlot( mSlots, index );
+    if ( slot == kNoSlot ) {
+        return E_FAIL; // the archive asked for an item that was not requested
+    }
+
+    if ( !mInputArchive.isItemFolder( index ) ) {
+        vector< byte_t >& out_buffer = mBuffers[ slot ];
+
+        // The whole content is written using a single allocation (if its declared size is plausible)
+        CBufOutStream::reserveBuffer( out_buffer, mInputArchive.plausibleItemSize( index ) );
+
+        auto* out_mem_stream_spec = new CBufOutStream( out_buffer );
+        CMyComPtr< ISequentialOutStream > outStreamLoc( out_mem_stream_spec );
+        mOutMemStream = outStreamLoc;
+        *outStream = outStreamLoc.Detach();
+    }
+
+    return S_OK;
+} catch ( const BitException& ) {
+    return E_OUTOFMEMORY;
+}
+
+STDMETHODIMP IndexedExtractCallback::SetOperationResult( Int32 operationResult ) {
+    switch ( operationResult ) {
+        case NArchive::NExtract::NOperationResult::kOK:
+            break;
+
+        default: {
+            mNumErrors++;
+
+            switch ( operationResult ) {
+                case NArchive::NExtract::NOperationResult::kUnsupportedMethod:
+                    mErrorMessage = kUnsupportedMethod;
+                    break;
+
+                case NArchive::NExtract::NOperationResult::kCRCError:
+                    mErrorMessage = kCRCFailed;
+                    break;
+
+                case NArchive::NExtract::NOperationResult::kDataError:
+                    mErrorMessage = kDataError;
+                    break;
+
+                default:
+                    mErrorMessage = kUnknownError;
+            }
+        }
+    }
+
+    mOutMemStream.Release();
+
+    return mNumErrors > 0 ? E_FAIL : S_OK;
+}
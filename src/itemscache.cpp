@@ -0,0 +1,401 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+/*
+ * bit7z - A C++ static library to interface with the 7-zip DLLs.
+ * Copyright (c) 2014-2019  Riccardo Ostani - All Rights Reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * Bit7z is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with bit7z; if not, see https://www.gnu.org/licenses/.
+ */
+
+#include "../include/itemscache.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#include "../include/bittypes.hpp"
+#include "../include/bitexception.hpp"
+#include "../include/fsutil.hpp"
+
+#include "Common/MyCom.h"
+#include "7zip/Archive/IArchive.h"
+#include "7zip/Common/FileStreams.h"
+
+using namespace bit7z;
+
+#if ( _MSC_VER <= 1700 )
+#define CONSTEXPR const
+#else
+#define CONSTEXPR constexpr
+#endif
+
+namespace {
+    enum ItemFlag : uint16_t {
+        HasPath = 1u << 0u,
+        HasIsDir = 1u << 1u,
+        IsDir = 1u << 2u,
+        HasSize = 1u << 3u,
+        HasPackSize = 1u << 4u,
+        HasMTime = 1u << 5u,
+        HasAttrib = 1u << 6u,
+        HasCRC = 1u << 7u,
+        HasEncrypted = 1u << 8u,
+        IsEncrypted = 1u << 9u,
+        HasBlock = 1u << 10u
+    };
+
+    const char kIndexSignature[ 8 ] = { 'B', '7', 'Z', 'I', 'N', 'D', 'E', 'X' };
+    CONSTEXPR auto kIndexVersion = 1u;
+    CONSTEXPR auto kHashedBytes = 64u * 1024u; // bytes of the archive hashed both at its head and at its tail
+
+    struct IndexHeader {
+        char signature[ 8 ];
+        uint32_t version;
+        int32_t formatValue;
+        uint64_t archiveSize;
+        uint64_t archiveLastWriteTime;
+        uint64_t archiveHash;
+        uint32_t itemsCount;
+        uint32_t pathsPoolSize;
+    };
+
+    BitPropVariant readProperty( IInArchive* in_archive, uint32_t index, BitProperty property ) {
+        BitPropVariant propvar;
+        HRESULT res = in_archive->GetProperty( index, static_cast< PROPID >( property ), &propvar );
+        if ( res != S_OK ) {
+            throw BitException( L"Could not retrieve property for item at index " + std::to_wstring( index ), res );
+        }
+        return propvar;
+    }
+
+    bool readBytes( ISequentialInStream* in_stream, void* data, size_t size ) {
+        auto* bytes = static_cast< byte_t* >( data );
+        while ( size > 0 ) {
+            UInt32 processed_size = 0;
+            UInt32 read_size = static_cast< UInt32 >( std::min< size_t >( size, UINT32_MAX ) );
+            if ( in_stream->Read( bytes, read_size, &processed_size ) != S_OK || processed_size == 0 ) {
+                return false;
+            }
+            bytes += processed_size;
+            size -= processed_size;
+        }
+        return true;
+    }
+
+    bool writeBytes( ISequentialOutStream* out_stream, const void* data, size_t size ) {
+        const auto* bytes = static_cast< const byte_t* >( data );
+        while ( size > 0 ) {
+            UInt32 processed_size = 0;
+            UInt32 write_size = static_cast< UInt32 >( std::min< size_t >( size, UINT32_MAX ) );
+            if ( out_stream->Write( bytes, write_size, &processed_size ) != S_OK || processed_size == 0 ) {
+                return false;
+            }
+            bytes += processed_size;
+            size -= processed_size;
+        }
+        return true;
+    }
+
+    template< typename T >
+    bool readColumn( ISequentialInStream* in_stream, vector< T >& column, size_t count ) {
+        column.resize( count );
+        return count == 0 || readBytes( in_stream, column.data(), count * sizeof( T ) );
+    }
+
+    template< typename T >
+    bool writeColumn( ISequentialOutStream* out_stream, const vector< T >& column ) {
+        return column.empty() || writeBytes( out_stream, column.data(), column.size() * sizeof( T ) );
+    }
+
+    void hashBytes( uint64_t& hash, const vector< byte_t >& bytes ) { // FNV-1a
+        for ( byte_t b : bytes ) {
+            hash ^= b;
+            hash *= 0x100000001B3ull;
+        }
+    }
+
+    /* Fills the archive fields of the header: besides the size and the modification time of the file, its head and
+     * its tail are hashed, since the formats keep there the information about the items (e.g. the signature header
+     * of 7z archives, the central directory of zip archives) */
+    bool readArchiveStamp( const wstring& archive_file, IndexHeader& header ) {
+        if ( !filesystem::fsutil::getFileStamp( archive_file, header.archiveSize, header.archiveLastWriteTime ) ) {
+            return false;
+        }
+        auto* file_stream_spec = new CInFileStream;
+        CMyComPtr< IInStream > file_stream = file_stream_spec;
+        if ( !file_stream_spec->Open( archive_file.c_str() ) ) {
+            return false;
+        }
+
+        uint64_t hash = 0xCBF29CE484222325ull;
+        vector< byte_t > buffer( static_cast< size_t >( std::min< uint64_t >( header.archiveSize, kHashedBytes ) ) );
+        if ( !readBytes( file_stream, buffer.data(), buffer.size() ) ) {
+            return false;
+        }
+        hashBytes( hash, buffer );
+
+        uint64_t tail_offset = std::max< uint64_t >( header.archiveSize - buffer.size(), buffer.size() );
+        buffer.resize( static_cast< size_t >( header.archiveSize - tail_offset ) );
+        if ( !buffer.empty() ) {
+            if ( file_stream->Seek( static_cast< Int64 >( tail_offset ), STREAM_SEEK_SET, nullptr ) != S_OK ||
+                 !readBytes( file_stream, buffer.data(), buffer.size() ) ) {
+                return false;
+            }
+            hashBytes( hash, buffer );
+        }
+        header.archiveHash = hash;
+        return true;
+    }
+}
+
+ItemsCache::ItemsCache() : mItemsCount( 0 ) {}
+
+ItemsCache::ItemsCache( IInArchive* in_archive ) : mItemsCount( 0 ) {
+    HRESULT res = in_archive->GetNumberOfItems( &mItemsCount );
+    if ( res != S_OK ) {
+        throw BitException( "Could not retrieve the number of items in the archive", res );
+    }
+
+    mPathsOffsets.reserve( mItemsCount + 1 );
+    mSizes.resize( mItemsCount, 0 );
+    mPackSizes.resize( mItemsCount, 0 );
+    mMTimes.resize( mItemsCount, FILETIME() );
+    mBlocks.resize( mItemsCount, 0 );
+    mAttributes.resize( mItemsCount, 0 );
+    mCRCs.resize( mItemsCount, 0 );
+    mFlags.resize( mItemsCount, 0 );
+
+    mPathsOffsets.push_back( 0 );
+    for ( uint32_t i = 0; i < mItemsCount; ++i ) {
+        uint16_t flags = 0;
+
+        BitPropVariant prop = readProperty( in_archive, i, BitProperty::Path );
+        if ( prop.isString() ) {
+            const wchar_t* path = prop.bstrVal;
+            mPathsPool.insert( mPathsPool.end(), path, path + SysStringLen( prop.bstrVal ) );
+            flags |= HasPath;
+        }
+        mPathsOffsets.push_back( static_cast< uint32_t >( mPathsPool.size() ) );
+
+        prop = readProperty( in_archive, i, BitProperty::IsDir );
+        if ( !prop.isEmpty() ) {
+            flags |= prop.getBool() ? HasIsDir | IsDir : HasIsDir;
+        }
+
+        prop = readProperty( in_archive, i, BitProperty::Size );
+        if ( !prop.isEmpty() ) {
+            mSizes[ i ] = prop.getUInt64();
+            flags |= HasSize;
+        }
+
+        prop = readProperty( in_archive, i, BitProperty::PackSize );
+        if ( !prop.isEmpty() ) {
+            mPackSizes[ i ] = prop.getUInt64();
+            flags |= HasPackSize;
+        }
+
+        prop = readProperty( in_archive, i, BitProperty::MTime );
+        if ( prop.isFiletime() ) {
+            mMTimes[ i ] = prop.getFiletime();
+            flags |= HasMTime;
+        }
+
+        prop = readProperty( in_archive, i, BitProperty::Attrib );
+        if ( !prop.isEmpty() ) {
+            mAttributes[ i ] = prop.getUInt32();
+            flags |= HasAttrib;
+        }
+
+        prop = readProperty( in_archive, i, BitProperty::CRC );
+        if ( !prop.isEmpty() ) {
+            mCRCs[ i ] = prop.getUInt32();
+            flags |= HasCRC;
+        }
+
+        prop = readProperty( in_archive, i, BitProperty::Encrypted );
+        if ( prop.isBool() ) {
+            flags |= prop.getBool() ? HasEncrypted | IsEncrypted : HasEncrypted;
+        }
+
+        prop = readProperty( in_archive, i, BitProperty::Block );
+        if ( !prop.isEmpty() ) {
+            mBlocks[ i ] = prop.getUInt64();
+            flags |= HasBlock;
+        }
+
+        mFlags[ i ] = flags;
+    }
+    mPathsPool.shrink_to_fit();
+}
+
+uint32_t ItemsCache::itemsCount() const {
+    return mItemsCount;
+}
+
+bool ItemsCache::isCached( BitProperty property ) {
+    switch ( property ) {
+        case BitProperty::Path:
+        case BitProperty::IsDir:
+        case BitProperty::Size:
+        case BitProperty::PackSize:
+        case BitProperty::MTime:
+        case BitProperty::Attrib:
+        case BitProperty::CRC:
+        case BitProperty::Encrypted:
+        case BitProperty::Block:
+            return true;
+        default:
+            return false;
+    }
+}
+
+BitPropVariant ItemsCache::itemProperty( uint32_t index, BitProperty property ) const {
+    if ( index >= mItemsCount ) {
+        throw BitException( L"Could not retrieve property for item at index " + std::to_wstring( index ),
+                            E_INVALIDARG );
+    }
+    switch ( property ) {
+        case BitProperty::Path:
+            return hasFlag( index, HasPath ) ? BitPropVariant( itemPath( index ) ) : BitPropVariant();
+        case BitProperty::IsDir:
+            return hasFlag( index, HasIsDir ) ? BitPropVariant( hasFlag( index, IsDir ) ) : BitPropVariant();
+        case BitProperty::Size:
+            return hasFlag( index, HasSize ) ? BitPropVariant( mSizes[ index ] ) : BitPropVariant();
+        case BitProperty::PackSize:
+            return hasFlag( index, HasPackSize ) ? BitPropVariant( mPackSizes[ index ] ) : BitPropVariant();
+        case BitProperty::MTime:
+            return hasFlag( index, HasMTime ) ? BitPropVariant( mMTimes[ index ] ) : BitPropVariant();
+        case BitProperty::Attrib:
+            return hasFlag( index, HasAttrib ) ? BitPropVariant( mAttributes[ index ] ) : BitPropVariant();
+        case BitProperty::CRC:
+            return hasFlag( index, HasCRC ) ? BitPropVariant( mCRCs[ index ] ) : BitPropVariant();
+        case BitProperty::Encrypted:
+            return hasFlag( index, HasEncrypted ) ? BitPropVariant( hasFlag( index, IsEncrypted ) ) : BitPropVariant();
+        case BitProperty::Block:
+            return hasFlag( index, HasBlock ) ? BitPropVariant( mBlocks[ index ] ) : BitPropVariant();
+        default:
+            return BitPropVariant();
+    }
+}
+
+wstring ItemsCache::itemPath( uint32_t index ) const {
+    const wchar_t* pool = mPathsPool.data();
+    return wstring( pool + mPathsOffsets[ index ], pool + mPathsOffsets[ index + 1 ] );
+}
+
+bool ItemsCache::isItemFolder( uint32_t index ) const {
+    return hasFlag( index, IsDir );
+}
+
+bool ItemsCache::isItemEncrypted( uint32_t index ) const {
+    return hasFlag( index, IsEncrypted );
+}
+
+bool ItemsCache::hasFlag( uint32_t index, uint16_t flag ) const {
+    return ( mFlags[ index ] & flag ) != 0;
+}
+
+bool ItemsCache::isConsistent() const {
+    if ( mPathsOffsets.size() != static_cast< size_t >( mItemsCount ) + 1 || mPathsOffsets.front() != 0 ||
+         mPathsOffsets.back() != mPathsPool.size() ) {
+        return false;
+    }
+    return std::is_sorted( mPathsOffsets.cbegin(), mPathsOffsets.cend() );
+}
+
+unique_ptr< ItemsCache > ItemsCache::loadIndexFile( const wstring& index_file,
+                                                    const wstring& archive_file,
+                                                    int& format_value ) {
+    auto* index_stream_spec = new CInFileStream;
+    CMyComPtr< IInStream > index_stream = index_stream_spec;
+    if ( !index_stream_spec->Open( index_file.c_str() ) ) {
+        return nullptr;
+    }
+
+    IndexHeader header;
+    if ( !readBytes( index_stream, &header, sizeof( header ) ) ||
+         std::memcmp( header.signature, kIndexSignature, sizeof( kIndexSignature ) ) != 0 ||
+         header.version != kIndexVersion ) {
+        return nullptr;
+    }
+
+    IndexHeader archive_header;
+    if ( !readArchiveStamp( archive_file, archive_header ) ||
+         archive_header.archiveSize != header.archiveSize ||
+         archive_header.archiveLastWriteTime != header.archiveLastWriteTime ||
+         archive_header.archiveHash != header.archiveHash ) {
+        return nullptr; // the archive was modified after the index was saved
+    }
+
+    // Checking the size of the index before allocating the columns
+    const uint64_t items_count = header.itemsCount;
+    uint64_t expected_size = sizeof( IndexHeader ) +
+                             items_count * ( 3 * sizeof( uint64_t ) + sizeof( FILETIME ) ) +
+                             ( items_count + 1 ) * sizeof( uint32_t ) +
+                             items_count * ( 2 * sizeof( uint32_t ) + sizeof( uint16_t ) ) +
+                             static_cast< uint64_t >( header.pathsPoolSize ) * sizeof( wchar_t );
+    UInt64 index_size = 0;
+    if ( index_stream_spec->GetSize( &index_size ) != S_OK || index_size != expected_size ) {
+        return nullptr;
+    }
+
+    unique_ptr< ItemsCache > items_cache( new ItemsCache() );
+    items_cache->mItemsCount = header.itemsCount;
+    const auto count = static_cast< size_t >( items_count );
+    if ( !readColumn( index_stream, items_cache->mSizes, count ) ||
+         !readColumn( index_stream, items_cache->mPackSizes, count ) ||
+         !readColumn( index_stream, items_cache->mMTimes, count ) ||
+         !readColumn( index_stream, items_cache->mBlocks, count ) ||
+         !readColumn( index_stream, items_cache->mPathsOffsets, count + 1 ) ||
+         !readColumn( index_stream, items_cache->mAttributes, count ) ||
+         !readColumn( index_stream, items_cache->mCRCs, count ) ||
+         !readColumn( index_stream, items_cache->mFlags, count ) ||
+         !readColumn( index_stream, items_cache->mPathsPool, header.pathsPoolSize ) ||
+         !items_cache->isConsistent() ) {
+        return nullptr;
+    }
+    format_value = header.formatValue;
+    return items_cache;
+}
+
+bool ItemsCache::saveIndexFile( const wstring& index_file, const wstring& archive_file, int format_value ) const {
+    IndexHeader header;
+    std::memcpy( header.signature, kIndexSignature, sizeof( kIndexSignature ) );
+    header.version = kIndexVersion;
+    header.formatValue = format_value;
+    header.itemsCount = mItemsCount;
+    header.pathsPoolSize = static_cast< uint32_t >( mPathsPool.size() );
+    if ( !readArchiveStamp( archive_file, header ) ) {
+        return false;
+    }
+
+    auto* index_stream_spec = new COutFileStream;
+    CMyComPtr< IOutStream > index_stream = index_stream_spec;
+    if ( !index_stream_spec->Create( index_file.c_str(), true ) ) {
+        return false;
+    }
+    /* Note: if a write fails, the (truncated) index file is left on disk, but it will be discarded when loaded,
+     * since its size will not match the one expected from its header */
+    return writeBytes( index_stream, &header, sizeof( header ) ) &&
+           writeColumn( index_stream, mSizes ) &&
+           writeColumn( index_stream, mPackSizes ) &&
+           writeColumn( index_stream, mMTimes ) &&
+           writeColumn( index_stream, mBlocks ) &&
+           writeColumn( index_stream, mPathsOffsets ) &&
+           writeColumn( index_stream, mAttributes ) &&
+           writeColumn( index_stream, mCRCs ) &&
+           writeColumn( index_stream, mFlags ) &&
+           writeColumn( index_stream, mPathsPool ) &&
+           index_stream_spec->Close() == S_OK;
+}
@@ -0,0 +1,66 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+/*
+ * bit7z - A C++ static library to interface with the 7-zip DLLs.
+ * Copyright (c) 2014-2019  Riccardo Ostani - All Rights Reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * Bit7z is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with bit7z; if not, see https://www.gnu.org/licenses/.
+ */
+
+#include "../include/itemspathindex.hpp"
+
+#include <cwctype>
+
+#include "../include/bitinputarchive.hpp"
+
+using namespace bit7z;
+
+ItemsPathIndex::ItemsPathIndex( const BitInputArchive& in_archive, bool case_sensitive )
+    : mCaseSensitive( case_sensitive ) {
+    uint32_t items_count = in_archive.itemsCount();
+    mIndices.reserve( items_count );
+    for ( uint32_t index = 0; index < items_count; ++index ) {
+        /* Note: if more items have the same path, the index refers to the last one, i.e. the one which would be
+         * the final content of the path when extracting the whole archive */
+        mIndices[ normalizePath( in_archive.itemPath( index ), case_sensitive ) ] = index;
+    }
+}
+
+bool ItemsPathIndex::find( const wstring& path, uint32_t& index ) const {
+    auto it = mIndices.find( normalizePath( path, mCaseSensitive ) );
+    if ( it == mIndices.end() ) {
+        return false;
+    }
+    index = it->second;
+    return true;
+}
+
+wstring ItemsPathIndex::normalizePath( const wstring& path, bool case_sensitive ) {
+    wstring result;
+    result.reserve( path.size() );
+    bool pending_separator = false;
+    for ( wchar_t c : path ) {
+        if ( c == L'/' || c == L'\\' ) {
+            pending_separator = !result.empty(); // leading and repeated separators are skipped
+            continue;
+        }
+        if ( pending_separator ) {
+            result.push_back( L'\\' );
+            pending_separator = false;
+        }
+        result.push_back( case_sensitive ? c : static_cast< wchar_t >( std::towlower( c ) ) );
+    }
+    return result; // trailing separators are never added
+}
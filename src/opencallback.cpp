@@ -35,7 +35,11 @@ using namespace bit7z::filesystem;
  *  + Error messages are not showed (see comments in ExtractCallback) */
 
 OpenCallback::OpenCallback( const BitArchiveHandler& handler, const wstring& filename )
-    : Callback( handler ), mSubArchiveMode( false ), mSubArchiveName( L"" ), mFileItem( filename ) {}
+    : Callback( handler ),
+      mSubArchiveMode( false ),
+      mPasswordRequested( false ),
+      mSubArchiveName( L"" ),
+      mFileItem( filename ) {}
 
 OpenCallback::~OpenCallback() {}
 
@@ -121,6 +125,7 @@ STDMETHODIMP OpenCallback::SetSubArchiveName( const wchar_t* name ) {
 }
 
 STDMETHODIMP OpenCallback::CryptoGetTextPassword( BSTR* password ) {
+    mPasswordRequested = true;
     wstring pass;
     if ( !mHandler.isPasswordDefined() ) {
         // You can ask real password here from user
@@ -140,3 +145,7 @@ STDMETHODIMP OpenCallback::CryptoGetTextPassword( BSTR* password ) {
 
     return StringToBstr( pass.c_str(), password );
 }
+
+bool OpenCallback::passwordRequested() const {
+    return mPasswordRequested;
+}
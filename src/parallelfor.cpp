@@ -0,0 +1,84 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+/*
+ * bit7z - A C++ static library to interface with the 7-zip DLLs.
+ * Copyright (c) 2014-2019  Riccardo Ostani - All Rights Reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * Bit7z is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with bit7z; if not, see https://www.gnu.org/licenses/.
+ */
+
+#include "../include/parallelfor.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+using namespace bit7z;
+
+void bit7z::parallelFor( size_t tasks_count, uint32_t threads_count, const function< void( size_t ) >& task ) {
+    if ( threads_count == 0 ) {
+        threads_count = std::max( std::thread::hardware_concurrency(), 1u );
+    }
+    size_t workers_count = std::min( static_cast< size_t >( threads_count ), tasks_count );
+
+    if ( workers_count <= 1 ) { // no need to spawn any thread
+        for ( size_t i = 0; i < tasks_count; ++i ) {
+            task( i );
+        }
+        return;
+    }
+
+    std::atomic< size_t > next_task( 0 );
+    std::atomic< bool > failed( false );
+    std::exception_ptr first_error;
+    std::mutex error_mutex;
+
+    auto worker = [ & ]() {
+        size_t i;
+        while ( !failed && ( i = next_task++ ) < tasks_count ) {
+            try {
+                task( i );
+            } catch ( ... ) {
+                std::lock_guard< std::mutex > lock( error_mutex );
+                if ( !first_error ) {
+                    first_error = std::current_exception();
+                }
+                failed = true;
+            }
+        }
+    };
+
+    std::vector< std::thread > workers;
+    workers.reserve( workers_count - 1 );
+    for ( size_t i = 1; i < workers_count; ++i ) {
+        try {
+            workers.push_back( std::thread( worker ) );
+        } catch ( const std::system_error& ) {
+            break; // cannot spawn more threads: the ones already running will take care of the remaining tasks
+        }
+    }
+    worker(); // the calling thread works too!
+    for ( auto& thread : workers ) {
+        thread.join();
+    }
+
+    if ( first_error ) {
+        std::rethrow_exception( first_error );
+    }
+}
@@ -0,0 +1,140 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+/*
+ * bit7z - A C++ static library to interface with the 7-zip DLLs.
+ * Copyright (c) 2014-2019  Riccardo Ostani - All Rights Reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * Bit7z is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with bit7z; if not, see https://www.gnu.org/licenses/.
+ */
+
+#include "../include/visitorextractcallback.hpp"
+
+#include "../include/cvisitoroutstream.hpp"
+#include "../include/bitpropvariant.hpp"
+#include "../include/bitexception.hpp"
+
+using namespace std;
+using namespace bit7z;
+
+VisitorExtractCallback::VisitorExtractCallback( const BitArchiveHandler& handler,
+                                                const BitInputArchive& inputArchive,
+                                                BitChunkVisitor& visitor )
+    : ExtractCallback( handler, inputArchive ),
+      mVisitor( visitor ),
+      mCurrentIndex( 0 ),
+      mAborted( false ),
+      mVisitorException() {}
+
+VisitorExtractCallback::~VisitorExtractCallback() {}
+
+wstring VisitorExtractCallback::getErrorMessage() const {
+    return mAborted ? kOperationAborted : ExtractCallback::getErrorMessage();
+}
+
+void VisitorExtractCallback::rethrowVisitorException() const {
+    if ( mVisitorException ) {
+        std::rethrow_exception( mVisitorException );
+    }
+}
+
+STDMETHODIMP VisitorExtractCallback::GetStream( UInt32 index, ISequentialOutStream** outStream, Int32 askExtractMode ) try {
+    *outStream = nullptr;
+    mOutVisitorStream.Release();
+
+    if ( askExtractMode != NArchive::NExtract::NAskMode::kExtract || mInputArchive.isItemFolder( index ) ) {
+        return S_OK;
+    }
+
+    // Get Name
+    BitPropVariant prop = mInputArchive.getItemProperty( index, BitProperty::Path );
+    wstring fullPath;
+
+    if ( prop.isEmpty() ) {
+        fullPath = kEmptyFileAlias;
+    } else if ( prop.isString() ) {
+        fullPath = prop.getString();
+    } else {
+        return E_FAIL;
+    }
+
+    bool proceed;
+    try {
+        proceed = mVisitor.onItemBegin( index, fullPath );
+    } catch ( ... ) {
+        mVisitorException = std::current_exception();
+        proceed = false;
+    }
+    if ( !proceed ) {
+        mAborted = true;
+        return E_ABORT;
+    }
+
+    mCurrentIndex = index;
+    auto* out_visitor_stream_spec = new CVisitorOutStream( mVisitor, index, mAborted, mVisitorException );
+    CMyComPtr< ISequentialOutStream > outStreamLoc( out_visitor_stream_spec );
+    mOutVisitorStream = outStreamLoc;
+    *outStream = outStreamLoc.Detach();
+
+    return S_OK;
+} catch ( const BitException& ) {
+    return E_OUTOFMEMORY;
+}
+
+STDMETHODIMP VisitorExtractCallback::SetOperationResult( Int32 operationResult ) {
+    switch ( operationResult ) {
+        case NArchive::NExtract::NOperationResult::kOK:
+            break;
+
+        default: {
+            mNumErrors++;
+
+            switch ( operationResult ) {
+                case NArchive::NExtract::NOperationResult::kUnsupportedMethod:
+                    mErrorMessage = kUnsupportedMethod;
+                    break;
+
+                case NArchive::NExtract::NOperationResult::kCRCError:
+                    mErrorMessage = kCRCFailed;
+                    break;
+
+                case NArchive::NExtract::NOperationResult::kDataError:
+                    mErrorMessage = kDataError;
+                    break;
+
+                default:
+                    mErrorMessage = kUnknownError;
+            }
+        }
+    }
+
+    bool visited = mOutVisitorStream != nullptr;
+    mOutVisitorStream.Release();
+
+    if ( visited ) {
+        bool proceed;
+        try {
+            proceed = mVisitor.onItemEnd( mCurrentIndex, operationResult == NArchive::NExtract::NOperationResult::kOK );
+        } catch ( ... ) {
+            mVisitorException = std::current_exception();
+            proceed = false;
+        }
+        if ( !proceed ) {
+            mAborted = true;
+            return E_ABORT;
+        }
+    }
+
+    return mNumErrors > 0 ? E_FAIL : S_OK;
+}
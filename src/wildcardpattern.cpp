@@ -0,0 +1,247 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+/*
+ * bit7z - A C++ static library to interface with the 7-zip DLLs.
+ * Copyright (c) 2014-2019  Riccardo Ostani - All Rights Reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * Bit7z is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with bit7z; if not, see https://www.gnu.org/licenses/.
+ */
+
+#include "../include/wildcardpattern.hpp"
+
+#include <algorithm>
+#include <cwctype>
+
+using namespace bit7z::filesystem;
+
+#if ( _MSC_VER <= 1700 )
+#define CONSTEXPR const
+#else
+#define CONSTEXPR constexpr
+#endif
+
+namespace {
+    // Maximum number of states of the patterns whose automaton is simulated using a bit mask
+    CONSTEXPR auto kMaxMaskStates = 64u;
+
+    inline bool isSeparator( wchar_t c ) {
+        return c == L'\\' || c == L'/';
+    }
+
+    inline wchar_t toLower( wchar_t c ) {
+        return static_cast< wchar_t >( std::towlower( c ) );
+    }
+}
+
+WildcardPattern::WildcardPattern( const wstring& pattern, bool case_sensitive, bool path_aware, bool char_sets )
+    : mCaseSensitive( case_sensitive ), mPathAware( path_aware ), mStarsMask( 0 ) {
+    if ( pattern.empty() ) { // as fsutil::wildcardMatch, an empty pattern matches any string
+        addToken( TokenType::AnyPath );
+    }
+
+    for ( size_t i = 0; i < pattern.size(); ++i ) {
+        wchar_t c = pattern[ i ];
+        switch ( c ) {
+            case L'?':
+                addToken( TokenType::AnyChar );
+                break;
+            case L'*':
+                if ( i + 1 < pattern.size() && pattern[ i + 1 ] == L'*' ) {
+                    addToken( TokenType::AnyPath );
+                    ++i;
+                } else {
+                    addToken( mPathAware ? TokenType::AnyString : TokenType::AnyPath );
+                }
+                break;
+            case L'[': {
+                size_t set_end = char_sets ? parseCharSet( pattern, i ) : wstring::npos;
+                if ( set_end == wstring::npos ) { // unterminated set (or sets not enabled), '[' is a normal character
+                    addToken( TokenType::Char, mCaseSensitive ? c : toLower( c ) );
+                } else {
+                    i = set_end;
+                }
+                break;
+            }
+            default:
+                addToken( TokenType::Char, mCaseSensitive ? c : toLower( c ) );
+        }
+    }
+
+    for ( size_t i = 0; i < mTokens.size() && i < kMaxMaskStates; ++i ) {
+        if ( mTokens[ i ].type == TokenType::AnyString || mTokens[ i ].type == TokenType::AnyPath ) {
+            mStarsMask |= static_cast< uint64_t >( 1 ) << i;
+        }
+    }
+}
+
+void WildcardPattern::addToken( TokenType type, wchar_t value ) {
+    if ( type == TokenType::AnyString || type == TokenType::AnyPath ) {
+        // Consecutive stars are merged in a single token (the most permissive one)
+        if ( !mTokens.empty() &&
+             ( mTokens.back().type == TokenType::AnyString || mTokens.back().type == TokenType::AnyPath ) ) {
+            if ( type == TokenType::AnyPath ) {
+                mTokens.back().type = TokenType::AnyPath;
+            }
+            return;
+        }
+    }
+    Token token;
+    token.type = type;
+    token.negated = false;
+    token.value = value;
+    token.rangesBegin = 0;
+    token.rangesEnd = 0;
+    mTokens.push_back( token );
+}
+
+/* Parses the set starting at pattern[ start ] (i.e. the '[' character) and returns the position of the closing ']'
+ * (or wstring::npos if the set is not terminated, in which case no token is added) */
+size_t WildcardPattern::parseCharSet( const wstring& pattern, size_t start ) {
+    size_t pos = start + 1;
+    bool negated = false;
+    if ( pos < pattern.size() && ( pattern[ pos ] == L'!' || pattern[ pos ] == L'^' ) ) {
+        negated = true;
+        ++pos;
+    }
+    // A ']' immediately after the opening of the set is a normal character of the set
+    size_t set_end = pattern.find( L']', pos < pattern.size() && pattern[ pos ] == L']' ? pos + 1 : pos );
+    if ( set_end == wstring::npos ) {
+        return wstring::npos;
+    }
+
+    Token token;
+    token.type = TokenType::CharSet;
+    token.negated = negated;
+    token.value = L'\0';
+    token.rangesBegin = static_cast< uint32_t >( mRanges.size() );
+    while ( pos < set_end ) {
+        CharRange range;
+        range.first = pattern[ pos ];
+        range.last = pattern[ pos ];
+        if ( pos + 2 < set_end && pattern[ pos + 1 ] == L'-' ) {
+            range.last = pattern[ pos + 2 ];
+            pos += 2;
+        }
+        mRanges.push_back( range );
+        ++pos;
+    }
+    token.rangesEnd = static_cast< uint32_t >( mRanges.size() );
+    mTokens.push_back( token );
+    return set_end;
+}
+
+bool WildcardPattern::inCharSet( const Token& token, wchar_t c ) const {
+    for ( uint32_t i = token.rangesBegin; i < token.rangesEnd; ++i ) {
+        const CharRange& range = mRanges[ i ];
+        if ( c >= range.first && c <= range.last ) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool WildcardPattern::matchesChar( const Token& token, wchar_t c ) const {
+    switch ( token.type ) {
+        case TokenType::Char:
+            return token.value == ( mCaseSensitive ? c : toLower( c ) );
+        case TokenType::AnyChar:
+        case TokenType::AnyString:
+            return !mPathAware || !isSeparator( c );
+        case TokenType::AnyPath:
+            return true;
+        case TokenType::CharSet: {
+            bool found = inCharSet( token, c );
+            if ( !found && !mCaseSensitive ) {
+                found = inCharSet( token, toLower( c ) ) ||
+                        inCharSet( token, static_cast< wchar_t >( std::towupper( c ) ) );
+            }
+            return found != token.negated;
+        }
+        default:
+            return false;
+    }
+}
+
+bool WildcardPattern::matches( const wstring& str ) const {
+    const size_t states_count = mTokens.size() + 1;
+    if ( states_count > kMaxMaskStates ) {
+        return matchesLongPattern( str );
+    }
+
+    /* Bit i of active is set if, after reading the current prefix of str, the automaton can be in the state where the
+     * first i tokens have been matched (the state mTokens.size() being the accepting one).
+     * Stars can match the empty string, so the state following a star is active whenever the star one is (note: since
+     * consecutive stars are merged, the state following a star is never a star one, so one shift is enough) */
+    uint64_t active = 1;
+    active |= ( active & mStarsMask ) << 1;
+    for ( wchar_t c : str ) {
+        uint64_t next_active = 0;
+        for ( size_t i = 0; i + 1 < states_count; ++i ) {
+            if ( ( active >> i & 1 ) == 0 ) {
+                continue;
+            }
+            if ( matchesChar( mTokens[ i ], c ) ) {
+                // A star consumes the character and remains active
+                next_active |= static_cast< uint64_t >( 1 ) << ( ( mStarsMask >> i & 1 ) != 0 ? i : i + 1 );
+            }
+        }
+        if ( next_active == 0 ) {
+            return false;
+        }
+        active = next_active | ( next_active & mStarsMask ) << 1;
+    }
+    return ( active >> ( states_count - 1 ) & 1 ) != 0;
+}
+
+bool WildcardPattern::matchesLongPattern( const wstring& str ) const {
+    // Same as matches(), but the states of the automaton are too many to be stored in a bit mask
+    const size_t states_count = mTokens.size() + 1;
+    vector< char > active( states_count, 0 );
+    vector< char > next_active( states_count, 0 );
+
+    // Stars can match the empty string, so the state following a star is active whenever the star one is
+    auto add_empty_matches = [ this, states_count ]( vector< char >& states ) {
+        for ( size_t i = 0; i + 1 < states_count; ++i ) {
+            TokenType type = mTokens[ i ].type;
+            if ( states[ i ] != 0 && ( type == TokenType::AnyString || type == TokenType::AnyPath ) ) {
+                states[ i + 1 ] = 1;
+            }
+        }
+    };
+
+    active[ 0 ] = 1;
+    add_empty_matches( active );
+    for ( wchar_t c : str ) {
+        bool any_active = false;
+        std::fill( next_active.begin(), next_active.end(), 0 );
+        for ( size_t i = 0; i + 1 < states_count; ++i ) {
+            if ( active[ i ] == 0 ) {
+                continue;
+            }
+            const Token& token = mTokens[ i ];
+            if ( matchesChar( token, c ) ) {
+                bool is_star = token.type == TokenType::AnyString || token.type == TokenType::AnyPath;
+                next_active[ is_star ? i : i + 1 ] = 1; // a star consumes the character and remains active
+                any_active = true;
+            }
+        }
+        if ( !any_active ) {
+            return false;
+        }
+        add_empty_matches( next_active );
+        active.swap( next_active );
+    }
+    return active[ states_count - 1 ] != 0;
+}
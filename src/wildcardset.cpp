@@ -0,0 +1,112 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+/*
+ * bit7z - A C++ static library to interface with the 7-zip DLLs.
+ * Copyright (c) 2014-2019  Riccardo Ostani - All Rights Reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * Bit7z is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with bit7z; if not, see https://www.gnu.org/licenses/.
+ */
+
+#include "../include/wildcardset.hpp"
+
+#include <algorithm>
+#include <cwctype>
+
+using namespace bit7z::filesystem;
+
+namespace {
+    inline bool isLiteral( const wstring& pattern, size_t begin, size_t end ) {
+        return std::find_if( pattern.begin() + begin, pattern.begin() + end, []( wchar_t c ) -> bool {
+            return c == L'*' || c == L'?';
+        }) == pattern.begin() + end;
+    }
+
+    wstring toLower( const wstring& str ) {
+        wstring result( str );
+        std::transform( result.begin(), result.end(), result.begin(), []( wchar_t c ) -> wchar_t {
+            return static_cast< wchar_t >( std::towlower( c ) );
+        });
+        return result;
+    }
+
+    void addLength( vector< size_t >& lengths, size_t length ) {
+        auto it = std::lower_bound( lengths.begin(), lengths.end(), length );
+        if ( it == lengths.end() || *it != length ) {
+            lengths.insert( it, length );
+        }
+    }
+}
+
+WildcardSet::WildcardSet( const vector< wstring >& patterns, bool case_sensitive )
+    : mCaseSensitive( case_sensitive ), mEmpty( patterns.empty() ), mMatchesAll( false ) {
+    for ( const auto& pattern : patterns ) {
+        size_t first = pattern.find_first_not_of( L'*' );
+        if ( pattern.empty() || first == wstring::npos ) { // e.g. "*", which matches any string
+            mMatchesAll = true;
+            continue;
+        }
+        size_t last = pattern.find_last_not_of( L'*' ) + 1; // i.e. the end of the pattern without trailing stars
+        const wstring& key = case_sensitive ? pattern : toLower( pattern );
+        if ( first == 0 && last == pattern.size() && isLiteral( pattern, 0, last ) ) { // "literal"
+            mLiterals.insert( key );
+        } else if ( first == 0 && isLiteral( pattern, 0, last ) ) { // "prefix*"
+            mPrefixes.insert( key.substr( 0, last ) );
+            addLength( mPrefixesLengths, last );
+        } else if ( last == pattern.size() && isLiteral( pattern, first, last ) ) { // "*suffix"
+            mSuffixes.insert( key.substr( first ) );
+            addLength( mSuffixesLengths, last - first );
+        } else {
+            mPatterns.push_back( WildcardPattern( pattern, case_sensitive ) );
+        }
+    }
+}
+
+bool WildcardSet::empty() const {
+    return mEmpty;
+}
+
+bool WildcardSet::matches( const wstring& str ) const {
+    if ( mMatchesAll ) {
+        return true;
+    }
+
+    const wstring folded_str = mCaseSensitive ? wstring() : toLower( str );
+    const wstring& key = mCaseSensitive ? str : folded_str;
+    if ( !mLiterals.empty() && mLiterals.find( key ) != mLiterals.end() ) {
+        return true;
+    }
+    for ( size_t length : mPrefixesLengths ) {
+        if ( length > key.size() ) {
+            break;
+        }
+        if ( mPrefixes.find( key.substr( 0, length ) ) != mPrefixes.end() ) {
+            return true;
+        }
+    }
+    for ( size_t length : mSuffixesLengths ) {
+        if ( length > key.size() ) {
+            break;
+        }
+        if ( mSuffixes.find( key.substr( key.size() - length ) ) != mSuffixes.end() ) {
+            return true;
+        }
+    }
+    for ( const auto& pattern : mPatterns ) {
+        if ( pattern.matches( str ) ) {
+            return true;
+        }
+    }
+    return false;
+}
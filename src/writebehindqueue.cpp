@@ -0,0 +1,239 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+/*
+ * bit7z - A C++ static library to interface with the 7-zip DLLs.
+ * Copyright (c) 2014-2019  Riccardo Ostani - All Rights Reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * Bit7z is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with bit7z; if not, see https://www.gnu.org/licenses/.
+ */
+
+#include "../include/writebehindqueue.hpp"
+
+#include <algorithm>
+
+#include "../include/bitexception.hpp"
+
+#include "Windows/FileDir.h"
+
+using namespace bit7z;
+using namespace NWindows;
+
+#if ( _MSC_VER <= 1700 )
+#define CONSTEXPR const
+#else
+#define CONSTEXPR constexpr
+#endif
+
+namespace {
+    CONSTEXPR auto kMaxChunkSize = static_cast< size_t >( 1024 * 1024 );
+    CONSTEXPR auto kMinChunkSize = static_cast< size_t >( 4 * 1024 );
+
+    HRESULT writeData( IOutStream* stream, const vector< byte_t >& data ) {
+        size_t written_size = 0;
+        while ( written_size < data.size() ) {
+            UInt32 processed_size = 0;
+            UInt32 write_size = static_cast< UInt32 >( std::min< size_t >( data.size() - written_size, UINT32_MAX ) );
+            HRESULT res = stream->Write( data.data() + written_size, write_size, &processed_size );
+            if ( res != S_OK ) {
+                return res;
+            }
+            if ( processed_size == 0 ) {
+                return E_FAIL;
+            }
+            written_size += processed_size;
+        }
+        return S_OK;
+    }
+}
+
+WriteBehindQueue::WriteBehindQueue( uint32_t writers_count, size_t memory_budget )
+    : mMemoryBudget( memory_budget ),
+      mChunkSize( std::min( kMaxChunkSize, std::max( memory_budget / 4, kMinChunkSize ) ) ),
+      mNextWriter( 0 ),
+      mPendingBytes( 0 ),
+      mPendingTasks( 0 ),
+      mStopping( false ),
+      mErrorCode( S_OK ) {
+    writers_count = std::max< uint32_t >( writers_count, 1 );
+    for ( uint32_t i = 0; i < writers_count; ++i ) {
+        mWriters.push_back( unique_ptr< Writer >( new Writer() ) );
+    }
+    // Note: the writers must be started only once all the other members have been initialized
+    try {
+        for ( auto& writer : mWriters ) {
+            writer->thread = std::thread( &WriteBehindQueue::run, this, std::ref( *writer ) );
+        }
+    } catch ( ... ) { // the destructor won't be called, so the writers already started must be stopped here
+        stop();
+        throw;
+    }
+}
+
+WriteBehindQueue::~WriteBehindQueue() {
+    stop();
+}
+
+size_t WriteBehindQueue::chunkSize() const {
+    return mChunkSize;
+}
+
+shared_ptr< WriteBehindQueue::File > WriteBehindQueue::addFile( COutFileStream* stream_spec,
+                                                                const wstring& path,
+                                                                uint64_t preallocated_size ) {
+    shared_ptr< File > file = std::make_shared< File >();
+    file->stream = stream_spec;
+    file->streamSpec = stream_spec;
+    file->path = path;
+    file->preallocatedSize = preallocated_size;
+    file->mtimeDefined = false;
+    file->mtime = FILETIME();
+    file->attribDefined = false;
+    file->attrib = 0;
+    std::lock_guard< std::mutex > lock( mMutex ); // files may be added by several decoding threads
+    file->writer = mNextWriter;
+    mNextWriter = ( mNextWriter + 1 ) % mWriters.size();
+    return file;
+}
+
+vector< byte_t > WriteBehindQueue::acquireBuffer() {
+    vector< byte_t > buffer;
+    {
+        std::lock_guard< std::mutex > lock( mMutex );
+        if ( !mFreeBuffers.empty() ) {
+            buffer.swap( mFreeBuffers.back() );
+            mFreeBuffers.pop_back();
+        }
+    }
+    buffer.reserve( mChunkSize );
+    return buffer;
+}
+
+HRESULT WriteBehindQueue::write( const shared_ptr< File >& file, vector< byte_t >& data ) {
+    return enqueue( file, data, false );
+}
+
+HRESULT WriteBehindQueue::close( const shared_ptr< File >& file ) {
+    vector< byte_t > no_data;
+    return enqueue( file, no_data, true );
+}
+
+HRESULT WriteBehindQueue::enqueue( const shared_ptr< File >& file, vector< byte_t >& data, bool close ) {
+    const size_t data_size = data.size();
+    std::unique_lock< std::mutex > lock( mMutex );
+    // Backpressure: waiting until the data fits in the memory budget (a single chunk is always accepted)
+    mTaskCompleted.wait( lock, [ this, data_size ]() -> bool {
+        return mPendingBytes == 0 || mPendingBytes + data_size <= mMemoryBudget || mErrorCode != S_OK;
+    });
+    // After an error, the files are still closed (and truncated) by the writers, but no more data is accepted
+    if ( mErrorCode != S_OK && !close ) {
+        return mErrorCode;
+    }
+    Writer& writer = *mWriters[ file->writer ];
+    writer.tasks.push_back( Task() );
+    Task& task = writer.tasks.back();
+    task.file = file;
+    task.data.swap( data );
+    task.close = close;
+    mPendingBytes += data_size;
+    ++mPendingTasks;
+    writer.tasksAvailable.notify_one();
+    return mErrorCode;
+}
+
+void WriteBehindQueue::run( Writer& writer ) {
+    for ( ;; ) {
+        Task task;
+        bool failed;
+        {
+            std::unique_lock< std::mutex > lock( mMutex );
+            writer.tasksAvailable.wait( lock, [ this, &writer ]() -> bool {
+                return !writer.tasks.empty() || mStopping;
+            });
+            if ( writer.tasks.empty() ) { // i.e. stopping, with all the tasks completed
+                return;
+            }
+            Task& next_task = writer.tasks.front();
+            task.file.swap( next_task.file );
+            task.data.swap( next_task.data );
+            task.close = next_task.close;
+            writer.tasks.pop_front();
+            failed = mErrorCode != S_OK;
+        }
+
+        File& file = *task.file;
+        HRESULT res = S_OK;
+        if ( !task.close ) {
+            if ( !failed ) { // after an error, the extraction is being aborted, so the data is discarded
+                res = writeData( file.stream, task.data );
+            }
+        } else {
+            if ( file.preallocatedSize != 0 && file.streamSpec->ProcessedSize != file.preallocatedSize ) {
+                file.streamSpec->SetSize( file.streamSpec->ProcessedSize );
+            }
+            if ( file.mtimeDefined ) {
+                file.streamSpec->SetMTime( &file.mtime );
+            }
+            res = file.streamSpec->Close();
+            if ( res == S_OK && file.attribDefined ) {
+                NFile::NDir::SetFileAttrib( file.path.c_str(), file.attrib );
+            }
+        }
+
+        {
+            std::lock_guard< std::mutex > lock( mMutex );
+            mPendingBytes -= task.data.size();
+            --mPendingTasks;
+            if ( !task.close && mFreeBuffers.size() <= mMemoryBudget / mChunkSize ) {
+                task.data.clear(); // recycling the buffer (keeping its capacity) for the next chunks
+                mFreeBuffers.push_back( vector< byte_t >() );
+                mFreeBuffers.back().swap( task.data );
+            }
+            if ( res != S_OK && mErrorCode == S_OK ) {
+                mErrorCode = res;
+                mErrorMessage = task.close ? L"Cannot close output file " : L"Cannot write output file ";
+                mErrorMessage += file.path;
+            }
+        }
+        mTaskCompleted.notify_all();
+    }
+}
+
+void WriteBehindQueue::finish() {
+    {
+        std::unique_lock< std::mutex > lock( mMutex );
+        mTaskCompleted.wait( lock, [ this ]() -> bool {
+            return mPendingTasks == 0;
+        });
+    }
+    stop();
+    if ( mErrorCode != S_OK ) {
+        throw BitException( mErrorMessage, mErrorCode );
+    }
+}
+
+void WriteBehindQueue::stop() {
+    {
+        std::lock_guard< std::mutex > lock( mMutex );
+        mStopping = true;
+    }
+    for ( auto& writer : mWriters ) {
+        writer->tasksAvailable.notify_one();
+    }
+    for ( auto& writer : mWriters ) {
+        if ( writer->thread.joinable() ) {
+            writer->thread.join();
+        }
+    }
+}